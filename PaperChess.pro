@@ -1,4 +1,4 @@
-QT += quick svg
+QT += quick svg concurrent
 CONFIG += c++11 debug_and_release debug
 
 # The following define makes your compiler emit warnings if you use
@@ -7,6 +7,9 @@ CONFIG += c++11 debug_and_release debug
 # deprecated API to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# Record the counters shown by the debug overlay in debug builds only.
+CONFIG(debug, debug|release): DEFINES += PAPERCHESS_INSTRUMENTATION
+
 # You can also make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
@@ -20,7 +23,28 @@ HEADERS += \
     src/gameengine.h \
     src/lineendpointspredicate.h \
     src/gameboard.h \
-    src/dotonborderpredicate.h
+    src/dotonborderpredicate.h \
+    src/dotimagecache.h \
+    src/gridmaterial.h \
+    src/dotmaterial.h \
+    src/linematerial.h \
+    src/shaderscale.h \
+    src/instrumentation.h \
+    src/debugmonitor.h \
+    src/tracing.h \
+    src/movelog.h \
+    src/rendersnapshot.h \
+    src/dotlistmodel.h \
+    src/linelistmodel.h \
+    src/playerlistmodel.h \
+    src/movehistorymodel.h \
+    src/startupprofile.h \
+    src/materialcache.h \
+    src/threatmap.h \
+    src/hintengine.h \
+    src/aiplayer.h \
+    src/endgamesolver.h \
+    src/proofsearch.h
 
 SOURCES += \
     src/main.cpp \
@@ -31,12 +55,33 @@ SOURCES += \
     src/gameengine.cpp \
     src/lineendpointspredicate.cpp \
     src/gameboard.cpp \
-    src/dotonborderpredicate.cpp
+    src/dotonborderpredicate.cpp \
+    src/dotimagecache.cpp \
+    src/gridmaterial.cpp \
+    src/dotmaterial.cpp \
+    src/linematerial.cpp \
+    src/shaderscale.cpp \
+    src/instrumentation.cpp \
+    src/debugmonitor.cpp \
+    src/tracing.cpp \
+    src/movelog.cpp \
+    src/dotlistmodel.cpp \
+    src/linelistmodel.cpp \
+    src/playerlistmodel.cpp \
+    src/movehistorymodel.cpp \
+    src/startupprofile.cpp \
+    src/materialcache.cpp \
+    src/threatmap.cpp \
+    src/hintengine.cpp \
+    src/aiplayer.cpp \
+    src/endgamesolver.cpp \
+    src/proofsearch.cpp
 
 RESOURCES += \
     qml.qrc \
     images.qrc \
-    fonts.qrc
+    fonts.qrc \
+    shaders.qrc
 
 # Additional import path used to resolve QML modules in Qt Creator's code model
 QML_IMPORT_PATH =
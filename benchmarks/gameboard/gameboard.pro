@@ -0,0 +1,74 @@
+# Headless benchmark of GameBoard's scene graph updates.
+#
+# Run the built binary without arguments; it first checks that Auto Connect
+# captures a surrounded dot, then renders offscreen unless QT_QPA_PLATFORM says
+# otherwise, and prints one row per board size and scenario.
+#
+# The default OpenGL scene graph measures the nodes the app draws with its
+# shaders. With QT_QUICK_BACKEND=software, the board falls back to plain
+# rectangle and texture nodes, so the node and vertex counts measure that
+# fallback instead.
+
+QT += quick svg concurrent
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = gameboardbenchmark
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../../src
+
+HEADERS += \
+    ../../src/stroke.h \
+    ../../src/dot.h \
+    ../../src/line.h \
+    ../../src/dotcoordinatespredicate.h \
+    ../../src/gameengine.h \
+    ../../src/lineendpointspredicate.h \
+    ../../src/gameboard.h \
+    ../../src/dotonborderpredicate.h \
+    ../../src/dotimagecache.h \
+    ../../src/gridmaterial.h \
+    ../../src/dotmaterial.h \
+    ../../src/linematerial.h \
+    ../../src/shaderscale.h \
+    ../../src/instrumentation.h \
+    ../../src/tracing.h \
+    ../../src/movelog.h \
+    ../../src/rendersnapshot.h \
+    ../../src/dotlistmodel.h \
+    ../../src/linelistmodel.h \
+    ../../src/playerlistmodel.h \
+    ../../src/movehistorymodel.h \
+    ../../src/materialcache.h \
+    ../../src/threatmap.h
+
+SOURCES += \
+    main.cpp \
+    ../../src/stroke.cpp \
+    ../../src/dot.cpp \
+    ../../src/line.cpp \
+    ../../src/dotcoordinatespredicate.cpp \
+    ../../src/gameengine.cpp \
+    ../../src/lineendpointspredicate.cpp \
+    ../../src/gameboard.cpp \
+    ../../src/dotonborderpredicate.cpp \
+    ../../src/dotimagecache.cpp \
+    ../../src/gridmaterial.cpp \
+    ../../src/dotmaterial.cpp \
+    ../../src/linematerial.cpp \
+    ../../src/shaderscale.cpp \
+    ../../src/instrumentation.cpp \
+    ../../src/tracing.cpp \
+    ../../src/movelog.cpp \
+    ../../src/dotlistmodel.cpp \
+    ../../src/linelistmodel.cpp \
+    ../../src/playerlistmodel.cpp \
+    ../../src/movehistorymodel.cpp \
+    ../../src/materialcache.cpp \
+    ../../src/threatmap.cpp
+
+RESOURCES += \
+    ../../images.qrc \
+    ../../shaders.qrc
@@ -0,0 +1,423 @@
+#include "dot.h"
+#include "dotimagecache.h"
+#include "gameboard.h"
+#include "gameengine.h"
+#include "stroke.h"
+#include "tracing.h"
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace
+{
+    std::atomic<quint64> allocationCount(0);
+}
+
+// count every allocation, so that the allocations made while updating the
+// paint node can be told apart
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+
+    if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+    /// Measurements of a single call to GameBoard::updatePaintNode().
+    struct Sample
+    {
+        qint64 nanoseconds;
+        quint64 allocations;
+
+        /// The number of nodes under the board node.
+        int nodes;
+
+        /// The number of vertices in the nodes which are not culled.
+        int vertices;
+    };
+
+    class BenchmarkBoard : public GameBoard
+    {
+    public:
+        explicit BenchmarkBoard(QQuickItem *parent = nullptr);
+
+        /// Gets the samples taken since they were last cleared.
+        const std::vector<Sample> &samples() const;
+        void clearSamples();
+
+    protected:
+        QSGNode *updatePaintNode(
+            QSGNode *oldNode,
+            UpdatePaintNodeData *data) override;
+
+    private:
+        static void countNodes(QSGNode *node, bool culled, Sample &sample);
+
+        std::vector<Sample> m_samples;
+    };
+
+    BenchmarkBoard::BenchmarkBoard(QQuickItem *parent)
+        : GameBoard(parent)
+    {
+    }
+
+    const std::vector<Sample> &BenchmarkBoard::samples() const
+    {
+        return m_samples;
+    }
+
+    void BenchmarkBoard::clearSamples()
+    {
+        m_samples.clear();
+    }
+
+    QSGNode *BenchmarkBoard::updatePaintNode(
+        QSGNode *oldNode,
+        UpdatePaintNodeData *data)
+    {
+        QElapsedTimer timer;
+        const quint64 allocations = allocationCount;
+
+        timer.start();
+
+        QSGNode *node = GameBoard::updatePaintNode(oldNode, data);
+
+        Sample sample = {
+            timer.nsecsElapsed(), allocationCount - allocations, 0, 0};
+
+        if (node != nullptr) {
+            countNodes(node, false, sample);
+        }
+
+        m_samples.push_back(sample);
+
+        return node;
+    }
+
+    void BenchmarkBoard::countNodes(QSGNode *node, bool culled, Sample &sample)
+    {
+        culled = culled || node->isSubtreeBlocked();
+
+        for (QSGNode *child = node->firstChild(); child != nullptr;
+             child = child->nextSibling()) {
+            ++sample.nodes;
+
+            if (child->type() == QSGNode::GeometryNodeType && !culled) {
+                const QSGGeometry *geometry =
+                    static_cast<QSGGeometryNode *>(child)->geometry();
+
+                if (geometry != nullptr) {
+                    sample.vertices += geometry->vertexCount();
+                }
+            }
+
+            countNodes(child, culled, sample);
+        }
+    }
+
+    /// Hosts a board in an offscreen window and renders it on demand.
+    class Bench
+    {
+    public:
+        Bench(int rows, int columns);
+
+        int dotCount() const;
+
+        /// Fills the specified fraction of the intersections with dots of
+        /// alternating players.
+        void fill(qreal density);
+
+        void idle(int frameCount);
+        void newDot(int frameCount);
+        void resize(int frameCount);
+        void zoom(int frameCount);
+
+    private:
+        void renderFrame();
+        void report(const char *scenario);
+
+        static const int WINDOW_WIDTH = 800;
+        static const int WINDOW_HEIGHT = 600;
+
+        int m_rows;
+        int m_columns;
+        QQuickWindow m_window;
+        GameEngine m_engine;
+        BenchmarkBoard *m_board;
+        std::mt19937 m_random;
+        std::vector<QPoint> m_freePoints;
+    };
+
+    Bench::Bench(int rows, int columns)
+        : m_rows(rows)
+        , m_columns(columns)
+        , m_board(new BenchmarkBoard(m_window.contentItem()))
+        , m_random(rows * 1000 + columns)
+    {
+        m_window.resize(WINDOW_WIDTH, WINDOW_HEIGHT);
+
+        QVariantList dotSources = {QStringLiteral("qrc:/images/dot.svg"),
+                                   QStringLiteral("qrc:/images/cross.svg")};
+
+        for (const QColor &color : {QColor(Qt::blue), QColor(Qt::red)}) {
+            Stroke *stroke = new Stroke(m_board);
+            stroke->setColor(color);
+            m_board->appendMarkStroke(stroke);
+        }
+
+        m_board->gridStroke()->setColor(Qt::gray);
+        m_board->setDotSources(dotSources);
+        m_board->setSize(QSizeF(WINDOW_WIDTH, WINDOW_HEIGHT));
+        m_board->setEngine(&m_engine);
+
+        m_engine.newGame(rows, columns, std::numeric_limits<int>::max());
+
+        for (int y = 0; y <= rows; ++y) {
+            for (int x = 0; x <= columns; ++x) {
+                m_freePoints.push_back(QPoint(x, y));
+            }
+        }
+
+        std::shuffle(m_freePoints.begin(), m_freePoints.end(), m_random);
+
+        m_window.show();
+        renderFrame();
+    }
+
+    int Bench::dotCount() const
+    {
+        return static_cast<int>(m_engine.getDots().size());
+    }
+
+    void Bench::fill(qreal density)
+    {
+        const int count =
+            static_cast<int>((m_rows + 1) * (m_columns + 1) * density);
+
+        while (dotCount() < count && !m_freePoints.empty()) {
+            const QPoint point = m_freePoints.back();
+            m_freePoints.pop_back();
+
+            if (m_engine.placeDot(point.x(), point.y())) {
+                m_engine.endTurn();
+            }
+        }
+
+        renderFrame();
+    }
+
+    void Bench::idle(int frameCount)
+    {
+        m_board->clearSamples();
+
+        for (int i = 0; i < frameCount; ++i) {
+            m_board->update();
+            renderFrame();
+        }
+
+        report("idle");
+    }
+
+    void Bench::newDot(int frameCount)
+    {
+        m_board->clearSamples();
+
+        for (int i = 0; i < frameCount && !m_freePoints.empty(); ++i) {
+            const QPoint point = m_freePoints.back();
+            m_freePoints.pop_back();
+
+            if (m_engine.placeDot(point.x(), point.y())) {
+                m_engine.endTurn();
+            }
+
+            renderFrame();
+        }
+
+        report("new dot");
+    }
+
+    void Bench::resize(int frameCount)
+    {
+        m_board->clearSamples();
+
+        for (int i = 0; i < frameCount; ++i) {
+            m_board->setWidth(WINDOW_WIDTH - (i % 2 + 1) * 10);
+            renderFrame();
+        }
+
+        m_board->setWidth(WINDOW_WIDTH);
+        renderFrame();
+
+        report("resize");
+    }
+
+    void Bench::zoom(int frameCount)
+    {
+        // zoom in and out around the centre of the window, the way the
+        // Flickable on the game page resizes its content
+        const QRectF viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+        m_board->clearSamples();
+
+        for (int i = 0; i < frameCount; ++i) {
+            const qreal scale = 1 + (i % 8 < 4 ? i % 8 : 8 - i % 8);
+            const QSizeF size(WINDOW_WIDTH * scale, WINDOW_HEIGHT * scale);
+
+            m_board->setPosition(QPointF(
+                (WINDOW_WIDTH - size.width()) / 2,
+                (WINDOW_HEIGHT - size.height()) / 2));
+            m_board->setSize(size);
+            m_board->setViewport(viewport.translated(-m_board->position()));
+            renderFrame();
+        }
+
+        report("zoom");
+    }
+
+    void Bench::renderFrame()
+    {
+        // grabbing the window synchronises and renders a frame right away
+        m_window.grabWindow();
+    }
+
+    void Bench::report(const char *scenario)
+    {
+        std::vector<Sample> samples = m_board->samples();
+
+        if (samples.empty()) {
+            return;
+        }
+
+        std::sort(
+            samples.begin(),
+            samples.end(),
+            [](const Sample &sample1, const Sample &sample2) {
+                return sample1.nanoseconds < sample2.nanoseconds;
+            });
+
+        const Sample &median = samples[samples.size() / 2];
+        quint64 allocations = 0;
+
+        for (const Sample &sample : samples) {
+            allocations += sample.allocations;
+        }
+
+        QTextStream(stdout)
+            << qSetFieldWidth(10) << QString("%1x%2").arg(m_rows).arg(m_columns)
+            << dotCount() << scenario << samples.size()
+            << median.nanoseconds / 1000 << samples.back().nanoseconds / 1000
+            << allocations / samples.size() << median.nodes << median.vertices
+            << qSetFieldWidth(0) << '\n';
+    }
+}
+
+namespace
+{
+    /// Surrounds a dot of the second player with four dots of the first,
+    /// connecting them either as they are placed or all at once, and checks
+    /// that Auto Connect captures it.
+    ///
+    /// \returns true if the dot is captured either way, false otherwise.
+    bool checkAutoConnectCapture()
+    {
+        // the first player's diamond around (2, 2), with the second player's
+        // dots placed in between
+        const QPoint moves[] = {
+            QPoint(2, 1),
+            QPoint(2, 2),
+            QPoint(1, 2),
+            QPoint(0, 0),
+            QPoint(3, 2),
+            QPoint(4, 4),
+            QPoint(2, 3)};
+
+        for (bool connectEachTurn : {true, false}) {
+            GameEngine engine;
+
+            engine.newGame(4, 4, 10);
+
+            for (int i = 0; i < 7; ++i) {
+                engine.placeDot(moves[i].x(), moves[i].y());
+
+                if (i % 2 == 0 && (connectEachTurn || i == 6)) {
+                    engine.connectAllDots();
+                }
+
+                engine.endTurn();
+            }
+
+            const Dot *surroundedDot = engine.getDotAt(2, 2);
+
+            if (surroundedDot == nullptr || surroundedDot->isActive()) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QGuiApplication app(argc, argv);
+
+    Tracing::initialize();
+
+    if (!checkAutoConnectCapture()) {
+        qCritical("Auto Connect did not capture a surrounded dot");
+
+        return 1;
+    }
+
+    // rasterise the dots up front, so that no frame waits for them
+    DotImageCache::distanceField(QStringLiteral("qrc:/images/dot.svg"));
+    DotImageCache::distanceField(QStringLiteral("qrc:/images/cross.svg"));
+
+    const int frameCount = 32;
+
+    QTextStream(stdout) << qSetFieldWidth(10) << "board"
+                        << "dots"
+                        << "scenario"
+                        << "frames"
+                        << "median us"
+                        << "max us"
+                        << "allocs"
+                        << "nodes"
+                        << "vertices" << qSetFieldWidth(0) << '\n';
+
+    for (int size : {16, 32, 64, 128, 256}) {
+        for (qreal density : {0.1, 0.4}) {
+            Bench bench(size, size * 3 / 2);
+            bench.fill(density);
+            bench.idle(frameCount);
+            bench.newDot(frameCount);
+            bench.resize(frameCount);
+            bench.zoom(frameCount);
+        }
+    }
+
+    return 0;
+}
@@ -7,6 +7,7 @@ Page {
         anchors.fill: parent
 
         source: "qrc:/images/cover.jpg"
+        asynchronous: true
         sourceSize.width: width
         fillMode: Image.PreserveAspectCrop
     }
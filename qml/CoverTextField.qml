@@ -10,24 +10,12 @@ Flow {
 
     spacing: label.height * 0.5
 
-    FontLoader {
-        id: printFont
-
-        source: "qrc:/fonts/CantataOne-Regular.ttf"
-    }
-
-    FontLoader {
-        id: handwritingFont
-
-        source: "qrc:/fonts/CoveredByYourGrace.ttf"
-    }
-
     Text {
         id: label
 
         color: "black"
         text: labelText + " :"
-        font.family: printFont.name
+        font.family: fontFamilies.print
     }
 
     TextInput {
@@ -37,7 +25,7 @@ Flow {
         height: label.height
 
         text: defaultText
-        font.family: handwritingFont.name
+        font.family: fontFamilies.handwriting
 
         Image {
             height: input.height * 0.1
@@ -0,0 +1,30 @@
+import QtQuick 2.9
+import PaperChess 1.0
+
+Rectangle {
+    id: overlay
+
+    width: reportText.implicitWidth + 8
+    height: reportText.implicitHeight + 8
+
+    color: Qt.rgba(0, 0, 0, 0.6)
+
+    DebugMonitor {
+        id: monitor
+    }
+
+    Text {
+        id: reportText
+
+        anchors {
+            left: parent.left
+            top: parent.top
+            margins: 4
+        }
+
+        color: "white"
+        text: monitor.available
+              ? monitor.report
+              : monitor.report + "\n" + qsTr("(counters are only recorded in debug builds)")
+    }
+}
@@ -4,23 +4,9 @@ import PaperChess 1.0
 Page {
     id: page
 
-    FontLoader {
-        id: regularFont
-
-        source: "qrc:/fonts/OpenSans-Regular.ttf"
-    }
-
-    FontLoader {
-        id: boldFont
-
-        source: "qrc:/fonts/Nunito-Bold.ttf"
-    }
-
-    FontLoader {
-        id: handwritingFont
-
-        source: "qrc:/fonts/CoveredByYourGrace.ttf"
-    }
+    property bool debugOverlayVisible: false
+    property bool legalMovesVisible: false
+    property bool threatsVisible: false
 
     Connections {
         target: gameEngine
@@ -36,9 +22,20 @@ Page {
         }
     }
 
+    HintEngine {
+        id: hintEngine
+
+        engine: gameEngine
+
+        onHintFound: gameBoard.markIntersection(x, y)
+    }
+
     Item {
         id: gameTracker
 
+        // the page is created after the first game has started
+        state: "placeDotWaiting"
+
         states: [
             State {
                 name: "placeDotWaiting"
@@ -116,6 +113,7 @@ Page {
         anchors.fill: parent
 
         source: "qrc:/images/wooden_texture.jpg"
+        asynchronous: true
         sourceSize.height: parent.height
         fillMode: Image.PreserveAspectCrop
     }
@@ -147,6 +145,7 @@ Page {
             anchors.fill: parent
 
             source: "qrc:/images/paper_texture.png"
+            asynchronous: true
             fillMode: Image.Tile
         }
 
@@ -156,6 +155,9 @@ Page {
             anchors.fill: parent
 
             engine: gameEngine
+            viewport: Qt.rect(flicky.contentX, flicky.contentY, flicky.width, flicky.height)
+            legalMovesVisible: page.legalMovesVisible
+            threatsVisible: page.threatsVisible
             dotSources: [
                 player1Indicator.playerMarkerSource,
                 player2Indicator.playerMarkerSource
@@ -176,6 +178,9 @@ Page {
                 var stage = gameEngine.stage
                 var pending = gameBoard.hasPendingMoves
 
+                // a move picked by the player takes over from the hint
+                hintEngine.cancel()
+
                 if (stage === GameEngine.PlaceDotStage) {
                     if (pending) {
                         gameTracker.state = "placeDotPending"
@@ -236,7 +241,11 @@ Page {
 
             onClicked: {
                 touchy.touchedPoint = Qt.point(mouseX, mouseY)
-                gameBoard.markPosition(touchy.touchedPoint)
+
+                // the board only zooms while the computer plays its turn
+                if (gameEngine.currentPlayer !== aiPlayer.player) {
+                    gameBoard.markPosition(touchy.touchedPoint)
+                }
             }
 
             onDoubleClicked: {
@@ -256,6 +265,35 @@ Page {
         }
     }
 
+    Shortcut {
+        sequence: "Ctrl+Shift+D"
+
+        onActivated: page.debugOverlayVisible = !page.debugOverlayVisible
+    }
+
+    Shortcut {
+        sequence: "Ctrl+Shift+L"
+
+        onActivated: page.legalMovesVisible = !page.legalMovesVisible
+    }
+
+    Shortcut {
+        sequence: "Ctrl+Shift+T"
+
+        onActivated: page.threatsVisible = !page.threatsVisible
+    }
+
+    Loader {
+        anchors {
+            left: flicky.left
+            top: flicky.top
+            margins: 2 * baseFontSize
+        }
+
+        active: page.debugOverlayVisible
+        source: "qrc:/qml/DebugOverlay.qml"
+    }
+
     Rectangle {
         id: gamebar
 
@@ -281,10 +319,11 @@ Page {
             }
             state: gameEngine.currentPlayer == 0 ? "active" : "inactive"
 
-            playerName: gameEngine.playerNames[0]
+            player: 0
+            playerModel: gameEngine.playerModel
             playerMarkerSource: "qrc:/images/dot.svg"
             font {
-                family: regularFont.name
+                family: fontFamilies.regular
                 pixelSize: 6 * baseFontSize
             }
             activeColor: stageBar.color
@@ -308,7 +347,7 @@ Page {
 
                text: qsTr("Dots: ") + gameEngine.turnsLeft
                font {
-                   family: regularFont.name
+                   family: fontFamilies.regular
                    pixelSize: 6 * baseFontSize
                }
            }
@@ -343,7 +382,7 @@ Page {
                 anchors.centerIn: parent
 
                 font {
-                    family: boldFont.name
+                    family: fontFamilies.bold
                     pixelSize: 8 * baseFontSize
                 }
             }
@@ -360,10 +399,11 @@ Page {
             }
             state: gameEngine.currentPlayer == 1 ? "active" : "inactive"
 
-            playerName: gameEngine.playerNames[1]
+            player: 1
+            playerModel: gameEngine.playerModel
             playerMarkerSource: "qrc:/images/cross.svg"
             font {
-                family: regularFont.name
+                family: fontFamilies.regular
                 pixelSize: 6 * baseFontSize
             }
             activeColor: stageBar.color
@@ -397,7 +437,7 @@ Page {
 
             text: qsTr("Menu")
             font {
-                family: regularFont.name
+                family: fontFamilies.regular
                 pixelSize: 10 * baseFontSize
             }
 
@@ -414,8 +454,29 @@ Page {
                 bottom: parent.bottom
             }
 
+            enabled: gameEngine.currentPlayer !== aiPlayer.player
             color: "transparent"
 
+            Button {
+                id: hintButton
+
+                anchors {
+                    left: parent.left
+                    bottom: parent.bottom
+                    leftMargin: 10 * baseFontSize
+                    bottomMargin: 3 * baseFontSize
+                }
+                visible: gameEngine.stage === GameEngine.PlaceDotStage
+
+                text: hintEngine.busy ? qsTr("Thinking") : qsTr("Hint")
+                font {
+                    family: fontFamilies.regular
+                    pixelSize: 8 * baseFontSize
+                }
+
+                onClicked: hintEngine.requestHint()
+            }
+
             Button {
                 id: cancelActionButton
 
@@ -428,7 +489,7 @@ Page {
 
                 text: qsTr("Cancel")
                 font {
-                    family: regularFont.name
+                    family: fontFamilies.regular
                     pixelSize: 8 * baseFontSize
                 }
 
@@ -454,7 +515,7 @@ Page {
 
                 text: qsTr("End Turn")
                 font {
-                    family: boldFont.name
+                    family: fontFamilies.bold
                     pixelSize: 10 * baseFontSize
                 }
 
@@ -512,7 +573,7 @@ Page {
                 Button {
                     text: qsTr("Resume")
                     font {
-                        family: handwritingFont.name
+                        family: fontFamilies.handwriting
                         pixelSize: 12 * baseFontSize
                     }
 
@@ -522,7 +583,7 @@ Page {
                 Button {
                     text: qsTr("End Game")
                     font {
-                        family: handwritingFont.name
+                        family: fontFamilies.handwriting
                         pixelSize: 12 * baseFontSize
                     }
 
@@ -563,7 +624,7 @@ Page {
 
                     text: qsTr("Are you sure you want to exit?")
                     font {
-                        family: handwritingFont.name
+                        family: fontFamilies.handwriting
                         pixelSize: 10 * baseFontSize
                     }
                     wrapMode: Text.WordWrap
@@ -577,7 +638,7 @@ Page {
 
                     text: qsTr("Yes")
                     font {
-                        family: handwritingFont.name
+                        family: fontFamilies.handwriting
                         pixelSize: 11 * baseFontSize
                     }
 
@@ -598,7 +659,7 @@ Page {
 
                     text: qsTr("No")
                     font {
-                        family: handwritingFont.name
+                        family: fontFamilies.handwriting
                         pixelSize: 11 * baseFontSize
                     }
 
@@ -3,12 +3,6 @@ import QtQuick 2.9
 CoverPage {
     id: page
 
-    FontLoader {
-        id: handwritingFont
-
-        source: "qrc:/fonts/CoveredByYourGrace.ttf"
-    }
-
     Item {
         anchors {
             fill: parent
@@ -20,7 +14,7 @@ CoverPage {
 
             text: qsTr("Game Rules")
             font {
-                family: handwritingFont.name
+                family: fontFamilies.handwriting
                 pixelSize: 12 * baseFontSize
             }
         }
@@ -40,7 +34,7 @@ CoverPage {
                      <li>The player who captures the most dots wins.</li>
                    </ol>"
             font {
-                family: handwritingFont.name
+                family: fontFamilies.handwriting
                 pixelSize: 10 * baseFontSize
             }
             lineHeight: 0.8
@@ -57,7 +51,7 @@ CoverPage {
 
             text: qsTr("Game Controls")
             font {
-                family: handwritingFont.name
+                family: fontFamilies.handwriting
                 pixelSize: 12 * baseFontSize
             }
         }
@@ -76,7 +70,7 @@ CoverPage {
                      <li> Zoom: Double tap or pinch</li>
                   </ul>"
             font {
-                family: handwritingFont.name
+                family: fontFamilies.handwriting
                 pixelSize: 10 * baseFontSize
             }
             lineHeight: 0.8
@@ -93,7 +87,7 @@ CoverPage {
 
         text: qsTr("Back")
         font {
-            family: handwritingFont.name
+            family: fontFamilies.handwriting
             pixelSize: 12 * baseFontSize
         }
 
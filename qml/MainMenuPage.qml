@@ -3,12 +3,6 @@ import QtQuick 2.9
 CoverPage {
     id: page
 
-    FontLoader {
-        id: handwritingFont
-
-        source: "qrc:/fonts/CoveredByYourGrace.ttf"
-    }
-
     Column {
         anchors.centerIn: parent
 
@@ -52,7 +46,7 @@ CoverPage {
 
                 text: qsTr("Play")
                 font {
-                    family: handwritingFont.name
+                    family: fontFamilies.handwriting
                     pixelSize: 17 * baseFontSize
                 }
 
@@ -64,7 +58,7 @@ CoverPage {
 
                 text: qsTr("How To Play")
                 font {
-                    family: handwritingFont.name
+                    family: fontFamilies.handwriting
                     pixelSize: 15 * baseFontSize
                 }
 
@@ -76,7 +70,7 @@ CoverPage {
 
                 text: qsTr("Exit")
                 font {
-                    family: handwritingFont.name
+                    family: fontFamilies.handwriting
                     pixelSize: 15 * baseFontSize
                 }
 
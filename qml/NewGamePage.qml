@@ -3,11 +3,7 @@ import QtQuick 2.9
 CoverPage {
     id: page
 
-    FontLoader {
-        id: handwritingFont
-
-        source: "qrc:/fonts/CoveredByYourGrace.ttf"
-    }
+    property bool computerOpponent: false
 
     Column {
         id: centerColumn
@@ -69,6 +65,20 @@ CoverPage {
                 labelFontSize: 8 * baseFontSize
                 textFontSize: 8 * baseFontSize
             }
+
+            Button {
+                id: opponentButton
+
+                text: page.computerOpponent
+                    ? qsTr("Against the computer")
+                    : qsTr("Against a friend")
+                font {
+                    family: fontFamilies.regular
+                    pixelSize: 8 * baseFontSize
+                }
+
+                onClicked: page.computerOpponent = !page.computerOpponent
+            }
         }
     }
 
@@ -90,7 +100,7 @@ CoverPage {
 
             text: qsTr("Start")
             font {
-                family: handwritingFont.name
+                family: fontFamilies.handwriting
                 pixelSize: 15 * baseFontSize
             }
 
@@ -100,10 +110,13 @@ CoverPage {
                     : player1TextField.defaultText
                 var player2Name = player2TextField.text !== ""
                     ? player2TextField.text
-                    : player2TextField.defaultText
+                    : page.computerOpponent
+                        ? qsTr("Computer")
+                        : player2TextField.defaultText
 
                 gameEngine.newGame(40, 25, 200)
                 gameEngine.playerNames = [player1Name, player2Name]
+                aiPlayer.player = page.computerOpponent ? 1 : -1
 
                 pageRequested("gamePage")
             }
@@ -121,7 +134,7 @@ CoverPage {
 
         text: qsTr("Back")
         font {
-            family: handwritingFont.name
+            family: fontFamilies.handwriting
             pixelSize: 12 * baseFontSize
         }
 
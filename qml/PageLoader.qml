@@ -0,0 +1,51 @@
+import QtQuick 2.9
+
+// Creates its page the first time the page is shown and forwards the page's
+// state and requests, so that pages which are never visited are never built.
+Loader {
+    id: pageLoader
+
+    property string pageState: "hidden"
+    property string initialState
+
+    signal pageRequested(string pageName)
+
+    function profileName() {
+        return String(source).replace(/^.*\//, "").replace(/\.qml$/, "")
+    }
+
+    active: false
+
+    onPageStateChanged: {
+        if (item) {
+            item.state = pageState
+        } else if (pageState === "shown") {
+            startupProfile.begin(profileName())
+            active = true
+        }
+    }
+
+    onLoaded: {
+        // start from the state the page was declared in, so that the first
+        // time it is shown animates like every other time
+        item.state = initialState
+        item.state = pageState
+        startupProfile.end(profileName())
+    }
+
+    Component.onCompleted: {
+        initialState = pageState
+
+        if (pageState === "shown") {
+            startupProfile.begin(profileName())
+            active = true
+        }
+    }
+
+    Connections {
+        target: pageLoader.item
+        ignoreUnknownSignals: true
+
+        onPageRequested: pageLoader.pageRequested(pageName)
+    }
+}
@@ -1,13 +1,28 @@
+import QtQml 2.2
 import QtQuick 2.9
 
 Rectangle {
     id: playerIndicator
 
-    property alias playerName: playerNameText.text
+    property int player
+    property alias playerModel: playerNameBindings.model
     property alias playerMarkerSource: playerMarkerImage.source
     property alias font: playerNameText.font
     property color activeColor: "white"
 
+    // one binding per player, of which only this player's is applied; a
+    // rename then re-evaluates only the binding of the renamed row
+    Instantiator {
+        id: playerNameBindings
+
+        delegate: Binding {
+            target: playerNameText
+            property: "text"
+            value: model.name
+            when: index === playerIndicator.player
+        }
+    }
+
     Text {
         id: playerNameText
 
@@ -3,12 +3,6 @@ import QtQuick 2.9
 CoverPage {
     id: page
 
-    FontLoader {
-        id: handwritingFont
-
-        source: "qrc:/fonts/CoveredByYourGrace.ttf"
-    }
-
     Column {
         id: title
 
@@ -40,18 +34,22 @@ CoverPage {
 
         spacing: parent.height * 0.025
 
-        Text {
-            anchors {
-                left: parent.left
-                right: parent.right
+        Repeater {
+            model: gameEngine.playerModel
+
+            Text {
+                anchors {
+                    left: parent.left
+                    right: parent.right
+                }
+
+                text: model.name + "\n" + model.score
+                font {
+                   family: fontFamilies.handwriting
+                   pixelSize: 12 * baseFontSize
+                }
+                horizontalAlignment: Text.AlignHCenter
             }
-
-            text: gameEngine.playerNames[0] + "\n" + gameEngine.playerScores[0]
-            font {
-               family: handwritingFont.name
-               pixelSize: 12 * baseFontSize
-            }
-            horizontalAlignment: Text.AlignHCenter
         }
 
         Text {
@@ -60,12 +58,34 @@ CoverPage {
                 right: parent.right
             }
 
-            text: gameEngine.playerNames[1] + "\n" + gameEngine.playerScores[1]
+            visible: endgameSolver.busy || endgameSolver.analysed
+            text: {
+                if (endgameSolver.busy) {
+                    return qsTr("Analysing the endgame...")
+                }
+
+                var difference = endgameSolver.analysedDifference
+
+                return qsTr("With the best moves found over the last %1 turns, %2 would have finished %3 points %4")
+                    .arg(endgameSolver.maxTurns)
+                    .arg(gameEngine.playerNames[endgameSolver.analysedPlayer])
+                    .arg(Math.abs(difference))
+                    .arg(difference >= 0 ? qsTr("ahead") : qsTr("behind"))
+            }
             font {
-               family: handwritingFont.name
-               pixelSize: 12 * baseFontSize
+               family: fontFamilies.regular
+               pixelSize: 6 * baseFontSize
             }
             horizontalAlignment: Text.AlignHCenter
+            wrapMode: Text.WordWrap
+        }
+    }
+
+    // the page is kept once it is built, so the analysis of each game starts
+    // as the page is shown
+    onStateChanged: {
+        if (state === "shown") {
+            endgameSolver.analyse()
         }
     }
 
@@ -79,7 +99,7 @@ CoverPage {
 
         text: qsTr("Main Menu")
         font {
-            family: handwritingFont.name
+            family: fontFamilies.handwriting
             pixelSize: 12 * baseFontSize
         }
 
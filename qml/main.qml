@@ -7,84 +7,89 @@ Window {
     height: 480
     title: qsTr("Paper Chess")
 
-    GamePage {
+    PageLoader {
         id: gamePage
 
         width: parent.width
         height: parent.height
-        state: "hidden"
+        source: "qrc:/qml/GamePage.qml"
+        pageState: "hidden"
 
         onPageRequested: {
             if (pageName === "scorePage") {
-                scorePage.state = "shown"
+                scorePage.pageState = "shown"
             }
         }
     }
 
-    ScorePage {
+    PageLoader {
         id: scorePage
 
         width: parent.width
         height: parent.height
-        state: "hiddenRight"
+        source: "qrc:/qml/ScorePage.qml"
+        pageState: "hiddenRight"
 
         onPageRequested: {
             if (pageName === "mainMenuPage") {
-                mainMenuPage.state = "shown"
-                newGamePage.state = "shown"
-                scorePage.state = "hiddenRight"
+                mainMenuPage.pageState = "shown"
+                newGamePage.pageState = "shown"
+                scorePage.pageState = "hiddenRight"
             }
         }
     }
 
-    NewGamePage {
+    PageLoader {
         id: newGamePage
 
         width: parent.width
         height: parent.height
-        state: "hidden"
+        source: "qrc:/qml/NewGamePage.qml"
+        pageState: "hidden"
 
         onPageRequested: {
             if (pageName === "gamePage") {
-                gamePage.state = "shown"
-                newGamePage.state = "hiddenLeft"
+                gamePage.pageState = "shown"
+                newGamePage.pageState = "hiddenLeft"
             }
             else if (pageName === "mainMenuPage") {
-                mainMenuPage.state = "shown"
+                mainMenuPage.pageState = "shown"
             }
         }
     }
 
-    HowToPlayPage {
+    PageLoader {
         id: howToPlayPage
 
         width: parent.width
         height: parent.height
-        state: "hidden"
+        source: "qrc:/qml/HowToPlayPage.qml"
+        pageState: "hidden"
 
         onPageRequested: {
             if (pageName === "mainMenuPage") {
-                mainMenuPage.state = "shown"
+                mainMenuPage.pageState = "shown"
             }
         }
     }
 
-    MainMenuPage {
+    PageLoader {
         id: mainMenuPage
 
         width: parent.width
         height: parent.height
-        state: "shown"
+        source: "qrc:/qml/MainMenuPage.qml"
+        pageState: "shown"
 
         onPageRequested: {
             if (pageName === "newGamePage") {
-                howToPlayPage.state = "hidden"
-                newGamePage.state = "shown"
-                mainMenuPage.state = "hiddenLeft"
+                howToPlayPage.pageState = "hidden"
+                newGamePage.pageState = "shown"
+                mainMenuPage.pageState = "hiddenLeft"
             }
             else if (pageName === "howToPlayPage") {
-                howToPlayPage.state = "shown"
-                mainMenuPage.state = "hiddenLeft"
+                howToPlayPage.pageState = "shown"
+                mainMenuPage.pageState = "hiddenLeft"
             }
         }
     }
@@ -0,0 +1,17 @@
+uniform lowp float qt_Opacity;
+uniform sampler2D distanceField;
+
+varying highp vec2 sampleCoord;
+varying highp float edgeWidth;
+
+void main()
+{
+    // the alpha is the distance field, which the colour was premultiplied by
+    // on upload
+    lowp vec4 texel = texture2D(distanceField, sampleCoord);
+    lowp float coverage =
+        smoothstep(0.5 - edgeWidth, 0.5 + edgeWidth, texel.a);
+    lowp vec3 color = texel.rgb / max(texel.a, 1.0 / 255.0);
+
+    gl_FragColor = vec4(color, 1.0) * (coverage * qt_Opacity);
+}
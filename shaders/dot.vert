@@ -0,0 +1,16 @@
+uniform highp mat4 qt_Matrix;
+uniform highp float pixelSize;
+
+attribute highp vec4 vertex;
+attribute highp vec2 texCoord;
+attribute highp float antialias;
+
+varying highp vec2 sampleCoord;
+varying highp float edgeWidth;
+
+void main()
+{
+    sampleCoord = texCoord;
+    edgeWidth = antialias * pixelSize;
+    gl_Position = qt_Matrix * vertex;
+}
@@ -0,0 +1,24 @@
+uniform lowp float qt_Opacity;
+uniform lowp vec4 color;
+uniform highp float cellSize;
+uniform highp float strokeWidth;
+uniform highp vec2 gridSize;
+uniform highp float pixelSize;
+
+varying highp vec2 position;
+
+void main()
+{
+    // distance to the nearest vertical and horizontal grid lines, with a
+    // device pixel of antialiasing measured in the same units
+    highp vec2 line =
+        clamp(floor(position / cellSize + 0.5), vec2(0.0), gridSize);
+    highp vec2 offset = abs(position - line * cellSize);
+
+    lowp float coverage = clamp(
+        (strokeWidth * 0.5 - min(offset.x, offset.y)) / pixelSize + 0.5,
+        0.0,
+        1.0);
+
+    gl_FragColor = color * (coverage * qt_Opacity);
+}
@@ -0,0 +1,17 @@
+uniform highp mat4 qt_Matrix;
+uniform highp float cellSize;
+uniform highp float strokeWidth;
+uniform highp float pixelSize;
+
+attribute highp vec4 vertex;
+attribute highp vec2 outward;
+
+varying highp vec2 position;
+
+void main()
+{
+    // leave room for the strokes and their antialiasing around the border
+    position =
+        vertex.xy * cellSize + outward * (strokeWidth * 0.5 + pixelSize);
+    gl_Position = qt_Matrix * vec4(position, 0.0, 1.0);
+}
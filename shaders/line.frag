@@ -0,0 +1,21 @@
+uniform lowp float qt_Opacity;
+uniform lowp vec4 color;
+uniform highp float pixelSize;
+
+varying highp vec2 position;
+varying highp float span;
+varying highp float lineWidth;
+
+void main()
+{
+    // distance to the nearest point on the segment, which rounds off the ends
+    // beyond either endpoint, with a device pixel of antialiasing measured in
+    // the same units
+    highp float beyond = max(-position.x, position.x - span);
+    highp float offset = length(vec2(max(beyond, 0.0), position.y));
+
+    lowp float coverage =
+        clamp((lineWidth * 0.5 - offset) / pixelSize + 0.5, 0.0, 1.0);
+
+    gl_FragColor = color * (coverage * qt_Opacity);
+}
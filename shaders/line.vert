@@ -0,0 +1,17 @@
+uniform highp mat4 qt_Matrix;
+
+attribute highp vec4 vertex;
+attribute highp vec2 offset;
+attribute highp vec2 segment;
+
+varying highp vec2 position;
+varying highp float span;
+varying highp float lineWidth;
+
+void main()
+{
+    position = offset;
+    span = segment.x;
+    lineWidth = segment.y;
+    gl_Position = qt_Matrix * vertex;
+}
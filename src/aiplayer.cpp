@@ -0,0 +1,634 @@
+#include "aiplayer.h"
+#include "dot.h"
+#include "endgamesolver.h"
+#include "gameengine.h"
+#include "proofsearch.h"
+#include <QBitArray>
+#include <QtConcurrent>
+#include <algorithm>
+
+AiPlayer::AiPlayer(QObject *parent)
+    : QObject(parent)
+    , m_engine(nullptr)
+    , m_player(-1)
+    , m_thinkTime(2000)
+    , m_thinking(false)
+    , m_pondering(false)
+    , m_searchKey(0)
+    , m_predictedMove(-1, -1)
+    , m_search(std::make_shared<Search>())
+{
+    m_search->table.assign(TABLE_SIZE, Entry());
+    m_search->stopped = false;
+    m_search->aborted = false;
+
+    connect(
+        &m_watcher,
+        &QFutureWatcher<QPoint>::finished,
+        this,
+        &AiPlayer::finishSearch);
+}
+
+AiPlayer::~AiPlayer()
+{
+    stopSearch();
+}
+
+GameEngine *AiPlayer::engine() const
+{
+    return m_engine;
+}
+
+void AiPlayer::setEngine(GameEngine *engine)
+{
+    if (engine == m_engine) {
+        return;
+    }
+
+    stopSearch();
+
+    if (m_engine != nullptr) {
+        disconnect(m_engine, nullptr, this, nullptr);
+    }
+
+    m_engine = engine;
+    m_predictedMove = QPoint(-1, -1);
+
+    if (m_engine != nullptr) {
+        // queued, so that the engine is done with the move before it is
+        // looked at
+        connect(
+            m_engine,
+            &GameEngine::gameStarted,
+            this,
+            &AiPlayer::update,
+            Qt::QueuedConnection);
+        connect(
+            m_engine,
+            &GameEngine::currentPlayerChanged,
+            this,
+            &AiPlayer::update,
+            Qt::QueuedConnection);
+        connect(
+            m_engine,
+            &GameEngine::stageChanged,
+            this,
+            &AiPlayer::update,
+            Qt::QueuedConnection);
+    }
+
+    update();
+}
+
+int AiPlayer::player() const
+{
+    return m_player;
+}
+
+void AiPlayer::setPlayer(int player)
+{
+    if (player == m_player) {
+        return;
+    }
+
+    stopSearch();
+
+    m_player = player;
+    m_predictedMove = QPoint(-1, -1);
+
+    emit playerChanged();
+
+    update();
+}
+
+int AiPlayer::thinkTime() const
+{
+    return m_thinkTime;
+}
+
+void AiPlayer::setThinkTime(int thinkTime)
+{
+    m_thinkTime = thinkTime;
+}
+
+bool AiPlayer::isThinking() const
+{
+    return m_thinking;
+}
+
+void AiPlayer::update()
+{
+    if (m_engine == nullptr || m_player < 0
+        || m_player >= m_engine->numPlayers()
+        || m_engine->stage() == GameEngine::EndStage) {
+        stopSearch();
+
+        return;
+    }
+
+    if (m_engine->currentPlayer() == m_player) {
+        // the connections are made along with the dot, so there is nothing
+        // to do in the connect stage
+        if (m_engine->stage() == GameEngine::PlaceDotStage
+            && !(m_thinking && m_searchKey == m_engine->positionKey())) {
+            startSearch(*m_engine, false);
+        }
+
+        return;
+    }
+
+    // ponder the position expected once the other player has moved
+    GameEngine expected;
+
+    expected.copyGame(*m_engine);
+
+    if (expected.stage() == GameEngine::ConnectDotsStage) {
+        expected.connectAllDots();
+        expected.endTurn();
+    } else if (expected.canPlaceDot(
+                   m_predictedMove.x(), m_predictedMove.y())) {
+        makeMove(expected, m_predictedMove);
+    }
+
+    if (!(m_pondering && m_searchKey == expected.positionKey())) {
+        startSearch(expected, true);
+    }
+}
+
+void AiPlayer::startSearch(const GameEngine &position, bool pondering)
+{
+    stopSearch();
+
+    // the copy is deleted on this thread once the search is done with it
+    std::shared_ptr<GameEngine> copy(
+        new GameEngine(), [](GameEngine *engine) { engine->deleteLater(); });
+
+    copy->copyGame(position);
+
+    const std::shared_ptr<const GameEngine> root = copy;
+    const std::shared_ptr<Search> search = m_search;
+
+    search->stopped = false;
+    search->deadline = pondering ? QDeadlineTimer(QDeadlineTimer::Forever)
+                                 : QDeadlineTimer(m_thinkTime);
+
+    m_searchKey = position.positionKey();
+    m_pondering = pondering;
+
+    m_watcher.setFuture(QtConcurrent::run(
+        [search, root] { return AiPlayer::search(search, root); }));
+
+    setThinking(!pondering);
+}
+
+void AiPlayer::stopSearch()
+{
+    if (m_watcher.isRunning()) {
+        m_search->stopped = true;
+        m_watcher.waitForFinished();
+    }
+
+    m_pondering = false;
+
+    setThinking(false);
+}
+
+void AiPlayer::finishSearch()
+{
+    // a finished ponder leaves its entries in the table and nothing else
+    if (!m_thinking) {
+        return;
+    }
+
+    const QPoint move = m_watcher.result();
+
+    setThinking(false);
+
+    if (m_engine->positionKey() != m_searchKey
+        || m_engine->currentPlayer() != m_player
+        || m_engine->stage() != GameEngine::PlaceDotStage) {
+        update();
+
+        return;
+    }
+
+    playMove(move);
+}
+
+void AiPlayer::playMove(const QPoint &move)
+{
+    // without a free point the turn is passed
+    if (m_engine->placeDot(move.x(), move.y())) {
+        m_engine->connectAllDots();
+    }
+
+    m_engine->endTurn();
+
+    // the search has most likely been through the position after the move,
+    // and its best reply is the one to ponder on
+    const quint64 key = m_engine->canonicalKey();
+    const Entry &entry = m_search->table[key % TABLE_SIZE];
+
+    m_predictedMove = entry.key == key
+        ? m_engine->fromCanonical(QPoint(entry.moveX, entry.moveY))
+        : QPoint(-1, -1);
+}
+
+void AiPlayer::setThinking(bool thinking)
+{
+    if (thinking == m_thinking) {
+        return;
+    }
+
+    m_thinking = thinking;
+
+    emit thinkingChanged();
+}
+
+QPoint AiPlayer::search(
+    const std::shared_ptr<Search> &search,
+    const std::shared_ptr<const GameEngine> &root)
+{
+    const int player = root->currentPlayer();
+    const int nextPlayer = (player + 1) % root->numPlayers();
+    const quint64 key = root->canonicalKey();
+    const Entry &entry = search->table[key % TABLE_SIZE];
+    QPoint bestMove = entry.key == key
+        ? root->fromCanonical(QPoint(entry.moveX, entry.moveY))
+        : QPoint(-1, -1);
+
+    if (root->stage() != GameEngine::PlaceDotStage) {
+        return bestMove;
+    }
+
+    // near the end the endgame solver searches to the last turn instead
+    if (EndgameSolver::canSolve(*root)) {
+        const EndgameSolver::Solution solution = EndgameSolver::solve(
+            *root, [&search] { return isTimeUp(*search); });
+
+        if (solution.solved) {
+            return solution.line.front();
+        }
+    }
+
+    // a proof only holds against the replies near its target, so the move
+    // is only tried first rather than played outright
+    const QPoint forcingMove = findForcingMove(*search, *root);
+
+    if (forcingMove.x() >= 0) {
+        bestMove = forcingMove;
+    }
+
+    while (static_cast<int>(search->positions.size()) < MAX_DEPTH) {
+        search->positions.emplace_back(new GameEngine());
+    }
+
+    for (int depth = 1; depth <= MAX_DEPTH; ++depth) {
+        const std::vector<QPoint> moves = findMoves(*root, player, bestMove);
+
+        if (moves.empty()) {
+            return QPoint(-1, -1);
+        }
+
+        // an interrupted iteration still searches the previous best first,
+        // so anything it finds to be better is better
+        QPoint depthBestMove = moves.front();
+        int alpha = -INFINITE_VALUE;
+
+        search->aborted = false;
+
+        for (const QPoint &move : moves) {
+            GameEngine &child = *search->positions[depth - 1];
+
+            child.copyGame(*root);
+            makeMove(child, move);
+
+            const int value = -negamax(
+                *search,
+                child,
+                nextPlayer,
+                depth - 1,
+                -INFINITE_VALUE,
+                -alpha);
+
+            if (search->aborted) {
+                break;
+            }
+
+            if (value > alpha) {
+                alpha = value;
+                depthBestMove = move;
+            }
+        }
+
+        if (search->aborted && alpha == -INFINITE_VALUE) {
+            return bestMove.x() < 0 ? moves.front() : bestMove;
+        }
+
+        bestMove = depthBestMove;
+
+        if (search->aborted) {
+            break;
+        }
+
+        Entry &rootEntry = search->table[key % TABLE_SIZE];
+        const QPoint tableMove = root->toCanonical(bestMove);
+
+        rootEntry = {
+            key,
+            alpha,
+            static_cast<qint16>(tableMove.x()),
+            static_cast<qint16>(tableMove.y()),
+            static_cast<qint8>(depth),
+            ExactBound};
+    }
+
+    return bestMove;
+}
+
+int AiPlayer::negamax(
+    Search &search,
+    const GameEngine &position,
+    int player,
+    int depth,
+    int alpha,
+    int beta)
+{
+    if (isTimeUp(search)) {
+        search.aborted = true;
+
+        return 0;
+    }
+
+    if (depth <= 0 || position.stage() == GameEngine::EndStage) {
+        return evaluate(position, player);
+    }
+
+    // the orientations of a position share an entry, which holds the move
+    // in the canonical orientation
+    const quint64 key = position.canonicalKey();
+    Entry &entry = search.table[key % TABLE_SIZE];
+    QPoint tableMove(-1, -1);
+
+    if (entry.key == key) {
+        tableMove = position.fromCanonical(QPoint(entry.moveX, entry.moveY));
+
+        if (entry.depth >= depth) {
+            if (entry.bound == ExactBound) {
+                return entry.value;
+            } else if (entry.bound == LowerBound) {
+                alpha = std::max(alpha, static_cast<int>(entry.value));
+            } else {
+                beta = std::min(beta, static_cast<int>(entry.value));
+            }
+
+            if (alpha >= beta) {
+                return entry.value;
+            }
+        }
+    }
+
+    const std::vector<QPoint> moves = findMoves(position, player, tableMove);
+
+    if (moves.empty()) {
+        return evaluate(position, player);
+    }
+
+    const int originalAlpha = alpha;
+    const int nextPlayer = (player + 1) % position.numPlayers();
+    int bestValue = -INFINITE_VALUE;
+    QPoint bestMove = moves.front();
+
+    // the children at this depth share an engine, which the search below
+    // them leaves alone
+    for (const QPoint &move : moves) {
+        GameEngine &child = *search.positions[depth - 1];
+
+        child.copyGame(position);
+        makeMove(child, move);
+
+        const int value =
+            -negamax(search, child, nextPlayer, depth - 1, -beta, -alpha);
+
+        if (search.aborted) {
+            return 0;
+        }
+
+        if (value > bestValue) {
+            bestValue = value;
+            bestMove = move;
+        }
+
+        alpha = std::max(alpha, value);
+
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    // a deeper result for the same position is worth more than this one
+    if (entry.key != key || entry.depth <= depth) {
+        tableMove = position.toCanonical(bestMove);
+        entry = {
+            key,
+            bestValue,
+            static_cast<qint16>(tableMove.x()),
+            static_cast<qint16>(tableMove.y()),
+            static_cast<qint8>(depth),
+            bestValue <= originalAlpha
+                ? UpperBound
+                : bestValue >= beta ? LowerBound : ExactBound};
+    }
+
+    return bestValue;
+}
+
+QPoint AiPlayer::findForcingMove(Search &search, const GameEngine &position)
+{
+    const int player = position.currentPlayer();
+    ProofSearch proofSearch(PROOF_TABLE_SIZE);
+    int targetCount = 0;
+
+    // the dots in contact with the player's own are the ones a forced
+    // capture could be built around
+    for (const Dot *dot : position.getDots()) {
+        if (targetCount == MAX_PROOF_TARGETS || isTimeUp(search)) {
+            break;
+        }
+
+        if (!dot->isActive() || dot->player() == player) {
+            continue;
+        }
+
+        bool inContact = false;
+
+        for (int dy = -1; dy <= 1 && !inContact; ++dy) {
+            for (int dx = -1; dx <= 1 && !inContact; ++dx) {
+                const Dot *neighbor =
+                    position.getDotAt(dot->x() + dx, dot->y() + dy);
+
+                inContact = neighbor != nullptr && neighbor->isActive()
+                    && neighbor->player() == player;
+            }
+        }
+
+        if (!inContact) {
+            continue;
+        }
+
+        ++targetCount;
+
+        if (proofSearch.search(
+                position,
+                QPoint(dot->x(), dot->y()),
+                PROOF_TURNS,
+                PROOF_NODE_BUDGET,
+                [&search] { return isTimeUp(search); })
+                == ProofSearch::ProvenResult
+            && !proofSearch.line().empty()) {
+            return proofSearch.line().front();
+        }
+    }
+
+    return QPoint(-1, -1);
+}
+
+void AiPlayer::makeMove(GameEngine &engine, const QPoint &move)
+{
+    engine.placeDot(move.x(), move.y());
+    engine.connectAllDots();
+    engine.endTurn();
+}
+
+std::vector<QPoint> AiPlayer::findMoves(
+    const GameEngine &position,
+    int player,
+    const QPoint &firstMove)
+{
+    struct Candidate
+    {
+        QPoint point;
+        int score;
+    };
+
+    const int rows = position.rows();
+    const int columns = position.columns();
+    const QBitArray ownThreats = position.threatenedPoints(player);
+    QBitArray opponentThreats(ownThreats.size(), false);
+    QBitArray candidatePoints(ownThreats.size(), false);
+    std::vector<Candidate> candidates;
+    bool hasDots = false;
+
+    for (int i = 0; i < position.numPlayers(); ++i) {
+        if (i != player) {
+            opponentThreats |= position.threatenedPoints(i);
+        }
+    }
+
+    // only placements next to a dot are tried, scored cheaply so that the
+    // likely best are searched first and the rest not at all
+    for (const Dot *dot : position.getDots()) {
+        if (!dot->isActive()) {
+            continue;
+        }
+
+        hasDots = true;
+
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                const int x = dot->x() + dx;
+                const int y = dot->y() + dy;
+
+                if (!position.canPlaceDot(x, y)
+                    || candidatePoints.testBit(y * (columns + 1) + x)) {
+                    continue;
+                }
+
+                candidatePoints.setBit(y * (columns + 1) + x);
+
+                int score = 0;
+
+                // blocking the opponents' threats and closing in on the dots
+                // the player threatens come first, then building walls
+                if (opponentThreats.testBit(y * (columns + 1) + x)) {
+                    score += 8;
+                }
+
+                for (int ny = y - 1; ny <= y + 1; ++ny) {
+                    for (int nx = x - 1; nx <= x + 1; ++nx) {
+                        const Dot *neighbor = position.getDotAt(nx, ny);
+
+                        if (neighbor == nullptr || !neighbor->isActive()) {
+                            continue;
+                        }
+
+                        if (neighbor->player() == player) {
+                            score += 2;
+                        } else if (ownThreats.testBit(
+                                       ny * (columns + 1) + nx)) {
+                            score += 4;
+                        } else {
+                            score += 1;
+                        }
+                    }
+                }
+
+                candidates.push_back({QPoint(x, y), score});
+            }
+        }
+    }
+
+    if (!hasDots && position.canPlaceDot(columns / 2, rows / 2)) {
+        candidates.push_back({QPoint(columns / 2, rows / 2), 0});
+    }
+
+    std::stable_sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const Candidate &a, const Candidate &b) {
+            return a.score > b.score;
+        });
+
+    std::vector<QPoint> moves;
+
+    if (position.canPlaceDot(firstMove.x(), firstMove.y())) {
+        moves.push_back(firstMove);
+    }
+
+    for (const Candidate &candidate : candidates) {
+        if (static_cast<int>(moves.size()) == MAX_MOVES) {
+            break;
+        }
+
+        if (candidate.point != firstMove) {
+            moves.push_back(candidate.point);
+        }
+    }
+
+    return moves;
+}
+
+int AiPlayer::evaluate(const GameEngine &position, int player)
+{
+    const QVariantList scores = position.playerScores();
+    int value = 0;
+
+    for (int i = 0; i < position.numPlayers(); ++i) {
+        const int threats = position.threatenedPoints(i).count(true);
+
+        if (i == player) {
+            value += CAPTURE_WEIGHT * scores.at(i).toInt()
+                + THREAT_WEIGHT * threats;
+        } else {
+            value -= CAPTURE_WEIGHT * scores.at(i).toInt()
+                + DEFENCE_WEIGHT * threats;
+        }
+    }
+
+    return value;
+}
+
+bool AiPlayer::isTimeUp(Search &search)
+{
+    return search.stopped || search.deadline.hasExpired();
+}
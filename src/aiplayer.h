@@ -0,0 +1,141 @@
+#ifndef AIPLAYER_H
+#define AIPLAYER_H
+
+#include <QDeadlineTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QPoint>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class GameEngine;
+
+/// Plays the turns of one player against the others.
+///
+/// A turn is a dot placed with all its connections made, chosen by an
+/// iterative deepening alpha-beta search on a worker thread within a time
+/// budget. While the other players think, the search carries on from the
+/// position expected after their move: the reply predicted by the previous
+/// search, or the dot actually placed once it is. The transposition table
+/// outlives each search, so the pondered positions are found in it when the
+/// turn comes, whether or not the prediction was right.
+///
+/// Before searching, the dots in contact with the player's are checked for a
+/// capture that can be forced within two turns against the replies near the
+/// dot. The move starting it is searched first, so the search confirms it or
+/// finds a reply it missed. Once the end of the game is within reach of
+/// EndgameSolver, the turns are played from its solution instead.
+class AiPlayer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(GameEngine *engine READ engine WRITE setEngine)
+    Q_PROPERTY(int player READ player WRITE setPlayer NOTIFY playerChanged)
+    Q_PROPERTY(int thinkTime READ thinkTime WRITE setThinkTime)
+    Q_PROPERTY(bool thinking READ isThinking NOTIFY thinkingChanged)
+
+public:
+    explicit AiPlayer(QObject *parent = nullptr);
+    ~AiPlayer() override;
+
+    GameEngine *engine() const;
+    void setEngine(GameEngine *engine);
+
+    /// Gets the player whose turns are played, or -1 if none.
+    int player() const;
+    void setPlayer(int player);
+
+    /// Gets the time to search for a move, in milliseconds.
+    int thinkTime() const;
+    void setThinkTime(int thinkTime);
+
+    /// Checks if a move is being searched for, not counting pondering.
+    bool isThinking() const;
+
+signals:
+    void playerChanged();
+    void thinkingChanged();
+
+private:
+    enum Bound : quint8
+    {
+        ExactBound,
+        LowerBound,
+        UpperBound
+    };
+
+    struct Entry
+    {
+        quint64 key;
+        qint32 value;
+        qint16 moveX;
+        qint16 moveY;
+        qint8 depth;
+        Bound bound;
+    };
+
+    /// The state shared with the search on the worker thread, only one of
+    /// which runs at a time.
+    struct Search
+    {
+        std::vector<Entry> table;
+        std::atomic<bool> stopped;
+        QDeadlineTimer deadline;
+        bool aborted;
+
+        // the engine the moves are tried on at each depth left, made by the
+        // first search and reused by every node after it
+        std::vector<std::unique_ptr<GameEngine>> positions;
+    };
+
+    void update();
+    void startSearch(const GameEngine &position, bool pondering);
+    void stopSearch();
+    void finishSearch();
+    void playMove(const QPoint &move);
+    void setThinking(bool thinking);
+
+    static QPoint search(
+        const std::shared_ptr<Search> &search,
+        const std::shared_ptr<const GameEngine> &root);
+    static int negamax(
+        Search &search,
+        const GameEngine &position,
+        int player,
+        int depth,
+        int alpha,
+        int beta);
+    static QPoint findForcingMove(Search &search, const GameEngine &position);
+    static void makeMove(GameEngine &engine, const QPoint &move);
+    static std::vector<QPoint> findMoves(
+        const GameEngine &position,
+        int player,
+        const QPoint &firstMove);
+    static int evaluate(const GameEngine &position, int player);
+    static bool isTimeUp(Search &search);
+
+    static const int TABLE_SIZE = 1 << 16;
+    static const int MAX_DEPTH = 8;
+    static const int MAX_MOVES = 12;
+    static const int CAPTURE_WEIGHT = 100;
+    static const int THREAT_WEIGHT = 4;
+    static const int DEFENCE_WEIGHT = 6;
+    static const int INFINITE_VALUE = 1 << 29;
+    static const int MAX_PROOF_TARGETS = 4;
+    static const int PROOF_TURNS = 2;
+    static const int PROOF_NODE_BUDGET = 2000;
+    static const int PROOF_TABLE_SIZE = 1 << 12;
+
+    GameEngine *m_engine;
+    int m_player;
+    int m_thinkTime;
+    bool m_thinking;
+    bool m_pondering;
+    quint64 m_searchKey;
+    QPoint m_predictedMove;
+    std::shared_ptr<Search> m_search;
+    QFutureWatcher<QPoint> m_watcher;
+};
+
+#endif // AIPLAYER_H
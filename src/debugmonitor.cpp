@@ -0,0 +1,144 @@
+#include "debugmonitor.h"
+#include "instrumentation.h"
+#include <QQuickWindow>
+#include <QStringList>
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    QString formatTime(qint64 nanoseconds)
+    {
+        return QString::number(nanoseconds / 1e6, 'f', 2);
+    }
+}
+
+DebugMonitor::DebugMonitor(QQuickItem *parent)
+    : QQuickItem(parent)
+    , m_frameTimes()
+    , m_frameIndex(0)
+    , m_frameCount(0)
+{
+    m_reportTimer.setInterval(REPORT_INTERVAL);
+
+    connect(
+        &m_reportTimer, &QTimer::timeout, this, &DebugMonitor::updateReport);
+
+    m_reportTimer.start();
+}
+
+bool DebugMonitor::isAvailable() const
+{
+    return Instrumentation::isEnabled();
+}
+
+QString DebugMonitor::report() const
+{
+    return m_report;
+}
+
+void DebugMonitor::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    if (change == ItemSceneChange) {
+        disconnect(m_frameConnection);
+
+        if (value.window != nullptr) {
+            m_frameConnection = connect(
+                value.window,
+                &QQuickWindow::frameSwapped,
+                this,
+                &DebugMonitor::recordFrame,
+                Qt::DirectConnection);
+        }
+    }
+
+    QQuickItem::itemChange(change, value);
+}
+
+void DebugMonitor::recordFrame()
+{
+    QMutexLocker locker(&m_frameMutex);
+
+    if (m_frameTimer.isValid()) {
+        m_frameTimes[m_frameIndex] = m_frameTimer.nsecsElapsed();
+        m_frameIndex = (m_frameIndex + 1) % FRAME_COUNT;
+
+        if (m_frameCount < FRAME_COUNT) {
+            ++m_frameCount;
+        }
+    }
+
+    m_frameTimer.start();
+}
+
+void DebugMonitor::updateReport()
+{
+    QString report;
+
+    {
+        QMutexLocker locker(&m_frameMutex);
+
+        const int count = m_frameCount;
+
+        if (count > 0) {
+            const qint64 total =
+                std::accumulate(m_frameTimes, m_frameTimes + count, qint64(0));
+            const qint64 longest =
+                *std::max_element(m_frameTimes, m_frameTimes + count);
+
+            report += QString("frames: avg %1 ms, max %2 ms (last %3)\n")
+                          .arg(formatTime(total / count))
+                          .arg(formatTime(longest))
+                          .arg(count);
+        }
+    }
+
+    if (Instrumentation::isEnabled()) {
+        // the times are in milliseconds and the rest are plain counts
+        const QList<QList<Instrumentation::Counter>> rows = {
+            {Instrumentation::PaintNodeTime},
+            {Instrumentation::GridNodeTime,
+             Instrumentation::OverviewNodeTime,
+             Instrumentation::DotContainerTime,
+             Instrumentation::LineContainerTime},
+            {Instrumentation::ChainContainerTime,
+             Instrumentation::ProvisionalDotContainerTime,
+             Instrumentation::ProvisionalChainContainerTime,
+             Instrumentation::LegalMoveNodeTime,
+             Instrumentation::ThreatNodeTime},
+            {Instrumentation::DotTileCount,
+             Instrumentation::LineTileCount,
+             Instrumentation::ChainNodeCount,
+             Instrumentation::TextureUploadCount},
+            {Instrumentation::PlaceDotTime,
+             Instrumentation::ConnectDotsTime,
+             Instrumentation::ConnectAllDotsTime,
+             Instrumentation::EndTurnTime}};
+
+        for (const QList<Instrumentation::Counter> &row : rows) {
+            QStringList items;
+
+            for (Instrumentation::Counter counter : row) {
+                const qint64 value = Instrumentation::value(counter);
+                const bool isCount = counter >= Instrumentation::DotTileCount
+                    && counter <= Instrumentation::TextureUploadCount;
+
+                items.append(
+                    QString("%1 %2")
+                        .arg(Instrumentation::name(counter))
+                        .arg(isCount ? QString::number(value)
+                                     : formatTime(value)));
+            }
+
+            report += items.join(", ") + '\n';
+        }
+    }
+
+    report.chop(1);
+
+    if (report != m_report) {
+        m_report = report;
+
+        emit reportChanged();
+    }
+}
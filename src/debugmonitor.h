@@ -0,0 +1,51 @@
+#ifndef DEBUGMONITOR_H
+#define DEBUGMONITOR_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QQuickItem>
+#include <QTimer>
+
+/// Collects the frame times of its window and the instrumentation counters
+/// into a report for the debug overlay.
+class DebugMonitor : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(bool available READ isAvailable CONSTANT)
+    Q_PROPERTY(QString report READ report NOTIFY reportChanged)
+
+public:
+    explicit DebugMonitor(QQuickItem *parent = nullptr);
+
+    /// Checks if the instrumentation counters are recorded in this build;
+    /// only the frame times are reported otherwise.
+    bool isAvailable() const;
+
+    QString report() const;
+
+signals:
+    void reportChanged();
+
+protected:
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
+private:
+    void recordFrame();
+    void updateReport();
+
+    static const int FRAME_COUNT = 120;
+    static const int REPORT_INTERVAL = 500;
+
+    QString m_report;
+    QTimer m_reportTimer;
+    QMetaObject::Connection m_frameConnection;
+
+    // frames are recorded on the render thread
+    QMutex m_frameMutex;
+    QElapsedTimer m_frameTimer;
+    qint64 m_frameTimes[FRAME_COUNT];
+    int m_frameIndex;
+    int m_frameCount;
+};
+
+#endif // DEBUGMONITOR_H
@@ -0,0 +1,306 @@
+#include "dotimagecache.h"
+#include "instrumentation.h"
+#include "tracing.h"
+#include <QMutexLocker>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGTexture>
+#include <QSvgRenderer>
+#include <cmath>
+#include <limits>
+
+QImage DotImageCache::distanceField(const QString &source)
+{
+    TRACE_SPAN("DotImageCache::distanceField");
+
+    QImage image = cachedDistanceField(source);
+
+    if (!image.isNull()) {
+        return image;
+    }
+
+    const int sourceSize = DISTANCE_FIELD_SIZE * SOURCE_OVERSAMPLING;
+    const QImage sourceImage = rasterize(source, sourceSize);
+
+    if (sourceImage.isNull()) {
+        return QImage();
+    }
+
+    std::vector<int> nearestInside(sourceSize * sourceSize, -1);
+    std::vector<int> nearestOutside(sourceSize * sourceSize, -1);
+
+    for (int y = 0; y < sourceSize; ++y) {
+        const QRgb *line =
+            reinterpret_cast<const QRgb *>(sourceImage.constScanLine(y));
+
+        for (int x = 0; x < sourceSize; ++x) {
+            const int index = y * sourceSize + x;
+
+            if (qAlpha(line[x]) >= 128) {
+                nearestInside[index] = index;
+            } else {
+                nearestOutside[index] = index;
+            }
+        }
+    }
+
+    propagateNearest(nearestInside, sourceSize);
+    propagateNearest(nearestOutside, sourceSize);
+
+    const qreal spread = DISTANCE_FIELD_SPREAD * SOURCE_OVERSAMPLING;
+    const auto distance = [sourceSize](int index, int seed) {
+        const int dx = index % sourceSize - seed % sourceSize;
+        const int dy = index / sourceSize - seed / sourceSize;
+
+        // measure to the edge between the pixels rather than their centres
+        return std::sqrt(static_cast<qreal>(dx * dx + dy * dy)) - 0.5;
+    };
+
+    image = QImage(
+        DISTANCE_FIELD_SIZE, DISTANCE_FIELD_SIZE, QImage::Format_ARGB32);
+    image.fill(qRgba(0, 0, 0, 0));
+
+    for (int v = 0; v < DISTANCE_FIELD_SIZE; ++v) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(v));
+
+        for (int u = 0; u < DISTANCE_FIELD_SIZE; ++u) {
+            const int x = u * SOURCE_OVERSAMPLING + SOURCE_OVERSAMPLING / 2;
+            const int y = v * SOURCE_OVERSAMPLING + SOURCE_OVERSAMPLING / 2;
+            const int index = y * sourceSize + x;
+            const int insideSeed = nearestInside[index];
+            const int outsideSeed = nearestOutside[index];
+
+            // check if the marker is empty
+            if (insideSeed < 0) {
+                continue;
+            }
+
+            // a marker without any outside is fully inside everywhere
+            qreal signedDistance = spread;
+
+            if (outsideSeed >= 0) {
+                signedDistance = insideSeed == index
+                    ? distance(index, outsideSeed)
+                    : -distance(index, insideSeed);
+            }
+
+            const int alpha = qBound(
+                0,
+                qRound(255 * (0.5 + signedDistance / (2 * spread))),
+                255);
+            const QRgb color = sourceImage.pixel(
+                insideSeed % sourceSize, insideSeed / sourceSize);
+
+            line[u] = qRgba(qRed(color), qGreen(color), qBlue(color), alpha);
+        }
+    }
+
+    DotImageCache *cache = instance();
+    QMutexLocker locker(&cache->m_imageMutex);
+
+    cache->m_images.insert(source, new QImage(image));
+
+    return image;
+}
+
+QImage DotImageCache::cachedDistanceField(const QString &source)
+{
+    DotImageCache *cache = instance();
+    QMutexLocker locker(&cache->m_imageMutex);
+
+    if (const QImage *cachedImage = cache->m_images.object(source)) {
+        return *cachedImage;
+    }
+
+    return QImage();
+}
+
+QImage DotImageCache::markerImage(const QImage &distanceField)
+{
+    DotImageCache *cache = instance();
+    QMutexLocker locker(&cache->m_imageMutex);
+
+    if (const QImage *cachedImage =
+            cache->m_markerImages.object(distanceField.cacheKey())) {
+        return *cachedImage;
+    }
+
+    QImage image(distanceField.size(), QImage::Format_ARGB32_Premultiplied);
+
+    for (int v = 0; v < image.height(); ++v) {
+        const QRgb *fieldLine =
+            reinterpret_cast<const QRgb *>(distanceField.constScanLine(v));
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(v));
+
+        for (int u = 0; u < image.width(); ++u) {
+            const QRgb texel = fieldLine[u];
+
+            // the alpha changes by 1 / (2 * spread) per texel, so stretching
+            // it around the edge at 0.5 leaves a texel wide ramp
+            const int alpha = qBound(
+                0,
+                qRound(
+                    (qAlpha(texel) - 127.5) * 2 * DISTANCE_FIELD_SPREAD
+                    + 127.5),
+                255);
+
+            line[u] = qPremultiply(
+                qRgba(qRed(texel), qGreen(texel), qBlue(texel), alpha));
+        }
+    }
+
+    cache->m_markerImages.insert(distanceField.cacheKey(), new QImage(image));
+
+    return image;
+}
+
+QSGTexture *DotImageCache::texture(QQuickWindow *window, const QImage &image)
+{
+    DotImageCache *cache = instance();
+    QMutexLocker locker(&cache->m_textureMutex);
+
+    if (!cache->m_textures.contains(window)) {
+        QObject::connect(
+            window,
+            &QQuickWindow::sceneGraphInvalidated,
+            window,
+            [cache, window] { cache->releaseTextures(window); },
+            Qt::DirectConnection);
+    }
+
+    QHash<qint64, CachedTexture> &textures = cache->m_textures[window];
+    CachedTexture &cachedTexture = textures[image.cacheKey()];
+
+    if (cachedTexture.texture == nullptr) {
+        cachedTexture.texture = window->createTextureFromImage(image);
+        cachedTexture.texture->setFiltering(QSGTexture::Linear);
+        cachedTexture.refCount = 0;
+
+        INSTRUMENT_ADD(TextureUploadCount, 1);
+    }
+
+    ++cachedTexture.refCount;
+
+    return cachedTexture.texture;
+}
+
+void DotImageCache::releaseTexture(QQuickWindow *window, QSGTexture *texture)
+{
+    DotImageCache *cache = instance();
+    QMutexLocker locker(&cache->m_textureMutex);
+
+    // the textures may already be gone along with the scene graph
+    if (!cache->m_textures.contains(window)) {
+        return;
+    }
+
+    QHash<qint64, CachedTexture> &textures = cache->m_textures[window];
+
+    for (auto it = textures.begin(); it != textures.end(); ++it) {
+        if (it->texture == texture) {
+            if (--it->refCount == 0) {
+                delete it->texture;
+                textures.erase(it);
+            }
+
+            return;
+        }
+    }
+}
+
+DotImageCache::DotImageCache()
+    : m_images(MAX_IMAGE_COUNT)
+    , m_markerImages(MAX_IMAGE_COUNT)
+{
+}
+
+DotImageCache *DotImageCache::instance()
+{
+    static DotImageCache cache;
+
+    return &cache;
+}
+
+QImage DotImageCache::rasterize(const QString &source, int size)
+{
+    QString fileString = source;
+    fileString.replace("qrc", "");
+
+    QSvgRenderer renderer(fileString);
+
+    if (!renderer.isValid()) {
+        return QImage();
+    }
+
+    // keep the colours unpremultiplied so they can be copied into the
+    // distance field as they are
+    QImage image(QSize(size, size), QImage::Format_ARGB32);
+    image.fill(qRgba(0, 0, 0, 0));
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    renderer.render(&painter);
+    painter.end();
+
+    return image;
+}
+
+void DotImageCache::propagateNearest(std::vector<int> &nearest, int size)
+{
+    const auto squaredDistance = [size](int index, int seed) {
+        if (seed < 0) {
+            return std::numeric_limits<int>::max();
+        }
+
+        const int dx = index % size - seed % size;
+        const int dy = index / size - seed / size;
+
+        return dx * dx + dy * dy;
+    };
+    const auto compare = [&](int x, int y, int dx, int dy) {
+        if (x + dx < 0 || x + dx >= size || y + dy < 0 || y + dy >= size) {
+            return;
+        }
+
+        const int index = y * size + x;
+        const int candidate = nearest[(y + dy) * size + x + dx];
+
+        if (squaredDistance(index, candidate)
+            < squaredDistance(index, nearest[index])) {
+            nearest[index] = candidate;
+        }
+    };
+
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            compare(x, y, -1, 0);
+            compare(x, y, -1, -1);
+            compare(x, y, 0, -1);
+            compare(x, y, 1, -1);
+        }
+        for (int x = size - 1; x >= 0; --x) {
+            compare(x, y, 1, 0);
+        }
+    }
+
+    for (int y = size - 1; y >= 0; --y) {
+        for (int x = size - 1; x >= 0; --x) {
+            compare(x, y, 1, 0);
+            compare(x, y, 1, 1);
+            compare(x, y, 0, 1);
+            compare(x, y, -1, 1);
+        }
+        for (int x = 0; x < size; ++x) {
+            compare(x, y, -1, 0);
+        }
+    }
+}
+
+void DotImageCache::releaseTextures(QQuickWindow *window)
+{
+    QMutexLocker locker(&m_textureMutex);
+
+    for (const CachedTexture &cachedTexture : m_textures.take(window)) {
+        delete cachedTexture.texture;
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef DOTIMAGECACHE_H
+#define DOTIMAGECACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <vector>
+
+class QQuickWindow;
+class QSGTexture;
+
+/// Process-wide cache of the distance field images of dot markers and the
+/// textures made from them.
+///
+/// Images are shared by every board in the process, textures by every board
+/// in the same window.
+class DotImageCache
+{
+public:
+    /// The width and height of a distance field image in texels.
+    static const int DISTANCE_FIELD_SIZE = 64;
+
+    /// The distance in texels over which the distance field goes from the edge
+    /// of the marker to fully inside or outside.
+    static const int DISTANCE_FIELD_SPREAD = 6;
+
+    /// Gets the distance field image of the SVG source.
+    ///
+    /// The alpha channel holds the signed distance to the edge of the marker,
+    /// mapped so that 0.5 is on the edge and larger values are inside. The
+    /// colour channels hold the colour of the nearest point of the marker and
+    /// are not premultiplied; the texture made from the image is, like any
+    /// other, so the shader divides the colour by the alpha.
+    ///
+    /// Rendering may take a while, so call this from a worker thread.
+    ///
+    /// \returns the image, or a null image if the source cannot be rendered.
+    static QImage distanceField(const QString &source);
+
+    /// Gets the distance field image like distanceField() but only if it is
+    /// already cached.
+    ///
+    /// Unlike distanceField(), this never renders and is cheap to call on the
+    /// GUI thread.
+    ///
+    /// \returns the image, or a null image if it is not cached.
+    static QImage cachedDistanceField(const QString &source);
+
+    /// Gets the marker drawn by a distance field image, with a texel of
+    /// antialiasing around its edge, for the renderers that cannot run the
+    /// distance field shader.
+    ///
+    /// \returns the premultiplied image, cached for as long as the distance
+    /// field is.
+    static QImage markerImage(const QImage &distanceField);
+
+    /// Gets the texture for the specified image in the specified window.
+    ///
+    /// Must be called on the window's render thread. The texture is owned by
+    /// the cache, and each call holds a reference to it until it is given back
+    /// with releaseTexture(). It is deleted once the last reference is given
+    /// back, or when the window's scene graph is invalidated.
+    ///
+    /// \returns the texture.
+    static QSGTexture *texture(QQuickWindow *window, const QImage &image);
+
+    /// Gives back a reference to a texture returned by texture(), so that the
+    /// textures of superseded images do not outlive their last user.
+    static void releaseTexture(QQuickWindow *window, QSGTexture *texture);
+
+private:
+    struct CachedTexture
+    {
+        QSGTexture *texture;
+        int refCount;
+    };
+
+    DotImageCache();
+
+    static DotImageCache *instance();
+
+    static QImage rasterize(const QString &source, int size);
+
+    /// Finds the nearest seed pixel for every pixel in a square grid.
+    ///
+    /// On input, seed pixels point to themselves and all other pixels point
+    /// to an invalid index. The propagation is an 8-point sequential
+    /// Euclidean distance transform.
+    static void propagateNearest(std::vector<int> &nearest, int size);
+
+    void releaseTextures(QQuickWindow *window);
+
+    static const int SOURCE_OVERSAMPLING = 4;
+    static const int MAX_IMAGE_COUNT = 16;
+
+    QMutex m_imageMutex;
+    QCache<QString, QImage> m_images;
+    QCache<qint64, QImage> m_markerImages;
+    QMutex m_textureMutex;
+    QHash<QQuickWindow *, QHash<qint64, CachedTexture>> m_textures;
+};
+
+#endif // DOTIMAGECACHE_H
@@ -0,0 +1,82 @@
+#include "dotlistmodel.h"
+
+DotListModel::DotListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int DotListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_dots.size();
+}
+
+QVariant DotListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_dots.size()) {
+        return QVariant();
+    }
+
+    const Dot &dot = m_dots.at(index.row());
+
+    switch (role) {
+        case PlayerRole:
+            return dot.player();
+        case XRole:
+            return dot.x();
+        case YRole:
+            return dot.y();
+        case ActiveRole:
+            return dot.isActive();
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> DotListModel::roleNames() const
+{
+    QHash<int, QByteArray> names;
+
+    names[PlayerRole] = "player";
+    names[XRole] = "x";
+    names[YRole] = "y";
+    names[ActiveRole] = "active";
+
+    return names;
+}
+
+void DotListModel::appendDot(const Dot &dot)
+{
+    const int row = m_dots.size();
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_dots.append(dot);
+    m_rows.insert(QPoint(dot.x(), dot.y()), row);
+    endInsertRows();
+}
+
+void DotListModel::deactivateDot(int x, int y)
+{
+    const QHash<QPoint, int>::const_iterator it = m_rows.find(QPoint(x, y));
+
+    if (it == m_rows.cend() || !m_dots.at(*it).isActive()) {
+        return;
+    }
+
+    m_dots[*it].deactivate();
+
+    const QModelIndex changed = index(*it);
+
+    emit dataChanged(changed, changed, {ActiveRole});
+}
+
+void DotListModel::clear()
+{
+    if (m_dots.isEmpty()) {
+        return;
+    }
+
+    beginResetModel();
+    m_dots.clear();
+    m_rows.clear();
+    endResetModel();
+}
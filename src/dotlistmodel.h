@@ -0,0 +1,47 @@
+#ifndef DOTLISTMODEL_H
+#define DOTLISTMODEL_H
+
+#include "dot.h"
+#include <QAbstractListModel>
+#include <QHash>
+#include <QPoint>
+#include <QVector>
+
+/// List of the dots placed in the current game, in the order they were
+/// placed.
+///
+/// The engine appends a row per dot placed and changes only the active role
+/// of a row when its dot is captured.
+class DotListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role
+    {
+        PlayerRole = Qt::UserRole + 1,
+        XRole,
+        YRole,
+        ActiveRole
+    };
+
+    explicit DotListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole)
+        const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void appendDot(const Dot &dot);
+
+    /// Marks the dot at the specified coordinates as captured.
+    void deactivateDot(int x, int y);
+
+    void clear();
+
+private:
+    QVector<Dot> m_dots;
+    QHash<QPoint, int> m_rows;
+};
+
+#endif // DOTLISTMODEL_H
@@ -0,0 +1,166 @@
+#include "dotmaterial.h"
+#include "dotimagecache.h"
+#include "shaderscale.h"
+#include <QOpenGLShaderProgram>
+#include <QRectF>
+#include <QSGTexture>
+
+namespace
+{
+    class DotMaterialShader : public QSGMaterialShader
+    {
+    public:
+        DotMaterialShader();
+
+        char const *const *attributeNames() const override;
+        void updateState(
+            const RenderState &state,
+            QSGMaterial *newMaterial,
+            QSGMaterial *oldMaterial) override;
+
+    protected:
+        void initialize() override;
+
+    private:
+        int m_matrixId;
+        int m_opacityId;
+        int m_pixelSizeId;
+    };
+
+    DotMaterialShader::DotMaterialShader()
+        : m_matrixId(-1)
+        , m_opacityId(-1)
+        , m_pixelSizeId(-1)
+    {
+        setShaderSourceFile(
+            QOpenGLShader::Vertex, QStringLiteral(":/shaders/dot.vert"));
+        setShaderSourceFile(
+            QOpenGLShader::Fragment, QStringLiteral(":/shaders/dot.frag"));
+    }
+
+    char const *const *DotMaterialShader::attributeNames() const
+    {
+        static const char *const names[] = {
+            "vertex", "texCoord", "antialias", nullptr};
+
+        return names;
+    }
+
+    void DotMaterialShader::updateState(
+        const RenderState &state,
+        QSGMaterial *newMaterial,
+        QSGMaterial *oldMaterial)
+    {
+        QOpenGLShaderProgram *program = QSGMaterialShader::program();
+
+        if (state.isMatrixDirty()) {
+            program->setUniformValue(m_matrixId, state.combinedMatrix());
+            program->setUniformValue(
+                m_pixelSizeId, ShaderScale::pixelSize(state));
+        }
+
+        if (state.isOpacityDirty()) {
+            program->setUniformValue(m_opacityId, state.opacity());
+        }
+
+        const DotMaterial *material = static_cast<DotMaterial *>(newMaterial);
+
+        if (oldMaterial == nullptr || material->compare(oldMaterial) != 0) {
+            material->texture()->bind();
+        } else {
+            material->texture()->updateBindOptions();
+        }
+    }
+
+    void DotMaterialShader::initialize()
+    {
+        QOpenGLShaderProgram *program = QSGMaterialShader::program();
+
+        m_matrixId = program->uniformLocation("qt_Matrix");
+        m_opacityId = program->uniformLocation("qt_Opacity");
+        m_pixelSizeId = program->uniformLocation("pixelSize");
+
+        program->bind();
+        program->setUniformValue("distanceField", 0);
+    }
+}
+
+void DotMaterial::Vertex::set(
+    float x,
+    float y,
+    float tx,
+    float ty,
+    float antialias)
+{
+    this->x = x;
+    this->y = y;
+    this->tx = tx;
+    this->ty = ty;
+    this->antialias = antialias;
+}
+
+DotMaterial::DotMaterial()
+    : m_texture(nullptr)
+{
+    setFlag(Blending);
+}
+
+QSGMaterialType *DotMaterial::type() const
+{
+    static QSGMaterialType type;
+
+    return &type;
+}
+
+QSGMaterialShader *DotMaterial::createShader() const
+{
+    return new DotMaterialShader();
+}
+
+int DotMaterial::compare(const QSGMaterial *other) const
+{
+    const DotMaterial *material = static_cast<const DotMaterial *>(other);
+
+    return m_texture->textureId() - material->m_texture->textureId();
+}
+
+QSGTexture *DotMaterial::texture() const
+{
+    return m_texture;
+}
+
+void DotMaterial::setTexture(QSGTexture *texture)
+{
+    m_texture = texture;
+}
+
+const QSGGeometry::AttributeSet &DotMaterial::attributes()
+{
+    static const QSGGeometry::Attribute data[] = {
+        QSGGeometry::Attribute::create(0, 2, QSGGeometry::FloatType, true),
+        QSGGeometry::Attribute::create(1, 2, QSGGeometry::FloatType),
+        QSGGeometry::Attribute::create(2, 1, QSGGeometry::FloatType)};
+    static const QSGGeometry::AttributeSet attributes = {
+        3, sizeof(Vertex), data};
+
+    return attributes;
+}
+
+void DotMaterial::appendQuad(Vertex *&vertices, const QRectF &rect, qreal scale)
+{
+    // half a unit of the geometry in distance field units, which the shader
+    // scales to half a device pixel
+    const float antialias = static_cast<float>(
+        0.5 / (scale * 2 * DotImageCache::DISTANCE_FIELD_SPREAD));
+    const float left = static_cast<float>(rect.left());
+    const float top = static_cast<float>(rect.top());
+    const float right = static_cast<float>(rect.right());
+    const float bottom = static_cast<float>(rect.bottom());
+
+    (vertices++)->set(left, top, 0, 0, antialias);
+    (vertices++)->set(right, top, 1, 0, antialias);
+    (vertices++)->set(left, bottom, 0, 1, antialias);
+    (vertices++)->set(right, top, 1, 0, antialias);
+    (vertices++)->set(right, bottom, 1, 1, antialias);
+    (vertices++)->set(left, bottom, 0, 1, antialias);
+}
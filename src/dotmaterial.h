@@ -0,0 +1,56 @@
+#ifndef DOTMATERIAL_H
+#define DOTMATERIAL_H
+
+#include <QSGGeometry>
+#include <QSGMaterial>
+
+class QSGTexture;
+
+/// Material which draws dot markers from a distance field texture.
+///
+/// The edge of the marker is found in the fragment shader, so the marker stays
+/// sharp at any size without re-rendering the texture.
+///
+/// The shader only runs on the OpenGL renderer; GameBoard draws the markers
+/// as textures of DotImageCache::markerImage() on the others.
+class DotMaterial : public QSGMaterial
+{
+public:
+    struct Vertex
+    {
+        float x;
+        float y;
+        float tx;
+        float ty;
+
+        /// Half a unit of the geometry in distance field units, which the
+        /// shader scales to the half-width of the antialiased edge.
+        float antialias;
+
+        void set(float x, float y, float tx, float ty, float antialias);
+    };
+
+    DotMaterial();
+
+    QSGMaterialType *type() const override;
+    QSGMaterialShader *createShader() const override;
+    int compare(const QSGMaterial *other) const override;
+
+    /// Gets the distance field texture; it is not owned by the material.
+    QSGTexture *texture() const;
+    void setTexture(QSGTexture *texture);
+
+    /// Gets the vertex layout used with this material.
+    static const QSGGeometry::AttributeSet &attributes();
+
+    /// Appends the two triangles of a marker covering the specified rect.
+    ///
+    /// \param scale the size of a distance field texel in the units of the
+    /// geometry.
+    static void appendQuad(Vertex *&vertices, const QRectF &rect, qreal scale);
+
+private:
+    QSGTexture *m_texture;
+};
+
+#endif // DOTMATERIAL_H
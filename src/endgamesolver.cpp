@@ -0,0 +1,502 @@
+#include "endgamesolver.h"
+#include "dot.h"
+#include "gameengine.h"
+#include <QBitArray>
+#include <QtConcurrent>
+#include <algorithm>
+
+EndgameSolver::EndgameSolver(QObject *parent)
+    : QObject(parent)
+    , m_engine(nullptr)
+    , m_busy(false)
+{
+    connect(
+        &m_watcher,
+        &QFutureWatcher<Solution>::finished,
+        this,
+        &EndgameSolver::finishAnalysis);
+}
+
+EndgameSolver::~EndgameSolver()
+{
+    cancel();
+
+    m_watcher.waitForFinished();
+}
+
+GameEngine *EndgameSolver::engine() const
+{
+    return m_engine;
+}
+
+void EndgameSolver::setEngine(GameEngine *engine)
+{
+    if (engine == m_engine) {
+        return;
+    }
+
+    cancel();
+
+    if (m_engine != nullptr) {
+        disconnect(m_engine, nullptr, this, nullptr);
+    }
+
+    m_engine = engine;
+    m_analysisPosition.reset();
+    m_analysis = Solution();
+
+    emit analysisChanged();
+
+    if (m_engine != nullptr) {
+        connect(m_engine, &GameEngine::gameStarted, this, [this] {
+            cancel();
+
+            m_analysisPosition.reset();
+            m_analysis = Solution();
+
+            emit analysisChanged();
+
+            watchPosition();
+        });
+        connect(
+            m_engine,
+            &GameEngine::stageChanged,
+            this,
+            &EndgameSolver::watchPosition);
+    }
+}
+
+bool EndgameSolver::isBusy() const
+{
+    return m_busy;
+}
+
+bool EndgameSolver::isAnalysed() const
+{
+    return m_analysis.solved;
+}
+
+int EndgameSolver::analysedPlayer() const
+{
+    return m_analysis.player;
+}
+
+int EndgameSolver::analysedDifference() const
+{
+    return m_analysis.scoreDifference;
+}
+
+QVariantList EndgameSolver::analysedLine() const
+{
+    QVariantList line;
+
+    for (const QPoint &point : m_analysis.line) {
+        line.append(point);
+    }
+
+    return line;
+}
+
+int EndgameSolver::maxTurns() const
+{
+    return MAX_TURNS;
+}
+
+bool EndgameSolver::canSolve(const GameEngine &position)
+{
+    return position.stage() == GameEngine::PlaceDotStage
+        && position.turnsLeft() <= MAX_TURNS
+        && position.columns() <= MAX_COLUMNS;
+}
+
+EndgameSolver::Solution EndgameSolver::solve(
+    const GameEngine &position,
+    const std::function<bool()> &stopped)
+{
+    struct RootMove
+    {
+        QPoint move;
+        int value;
+        bool exact;
+    };
+
+    Solution solution;
+
+    solution.player = position.currentPlayer();
+
+    if (!canSolve(position)) {
+        return solution;
+    }
+
+    const int nextPlayer = (solution.player + 1) % position.numPlayers();
+    Context context;
+    std::vector<RootMove> rootMoves;
+
+    context.stopped = stopped;
+    context.aborted = false;
+    context.rootAlpha = -INFINITE_VALUE;
+
+    for (const QPoint &move : findMoves(position, QPoint(-1, -1))) {
+        rootMoves.push_back({move, -INFINITE_VALUE, false});
+    }
+
+    // each root move is searched with the best value found so far by any of
+    // them, so that the workers cut off as much as a single one would
+    QtConcurrent::blockingMap(
+        rootMoves,
+        std::function<void(RootMove &)>([&](RootMove &rootMove) {
+            std::vector<std::unique_ptr<GameEngine>> positions;
+            GameEngine child;
+
+            child.copyGame(position);
+            makeMove(child, rootMove.move);
+
+            const int alpha = context.rootAlpha;
+            const int value = -negamax(
+                context,
+                positions,
+                0,
+                child,
+                nextPlayer,
+                -INFINITE_VALUE,
+                -alpha);
+
+            if (context.aborted) {
+                return;
+            }
+
+            rootMove.value = value;
+            rootMove.exact = value > alpha;
+
+            int bestValue = context.rootAlpha;
+
+            while (value > bestValue
+                   && !context.rootAlpha.compare_exchange_weak(
+                       bestValue, value)) {
+            }
+        }));
+
+    if (context.aborted) {
+        return solution;
+    }
+
+    // only the values above the bound they were searched with are exact, and
+    // the best of them is the best of all
+    const RootMove *best = nullptr;
+
+    for (const RootMove &rootMove : rootMoves) {
+        if (rootMove.exact
+            && (best == nullptr || rootMove.value > best->value)) {
+            best = &rootMove;
+        }
+    }
+
+    solution.solved = true;
+    solution.scoreDifference = best->value;
+    solution.line.push_back(best->move);
+
+    // the rest of the line is read back from the memo, as far as it has kept
+    // the exact values along it
+    GameEngine line;
+
+    line.copyGame(position);
+    makeMove(line, best->move);
+
+    while (line.stage() != GameEngine::EndStage) {
+        const auto it = context.memo.find(memoKey(line));
+
+        if (it == context.memo.end() || it->second.bound != ExactBound) {
+            break;
+        }
+
+        const QPoint move =
+            line.fromCanonical(QPoint(it->second.moveX, it->second.moveY));
+
+        solution.line.push_back(move);
+        makeMove(line, move);
+    }
+
+    return solution;
+}
+
+void EndgameSolver::analyse()
+{
+    cancel();
+
+    if (m_analysisPosition == nullptr) {
+        return;
+    }
+
+    const std::shared_ptr<const GameEngine> position = m_analysisPosition;
+    const std::shared_ptr<std::atomic<bool>> stopped =
+        std::make_shared<std::atomic<bool>>(false);
+
+    m_stopped = stopped;
+    m_watcher.setFuture(QtConcurrent::run([position, stopped] {
+        return solve(*position, [stopped] { return stopped->load(); });
+    }));
+
+    setBusy(true);
+}
+
+void EndgameSolver::cancel()
+{
+    if (m_stopped != nullptr) {
+        *m_stopped = true;
+        m_stopped.reset();
+    }
+
+    setBusy(false);
+}
+
+void EndgameSolver::watchPosition()
+{
+    // the analysis starts from the first player's turn, so that every player
+    // has the same number of turns left
+    if (m_analysisPosition != nullptr
+        || m_engine->currentPlayer() != 0
+        || !canSolve(*m_engine)) {
+        return;
+    }
+
+    m_analysisPosition.reset(
+        new GameEngine(), [](GameEngine *engine) { engine->deleteLater(); });
+    m_analysisPosition->copyGame(*m_engine);
+}
+
+void EndgameSolver::finishAnalysis()
+{
+    // discard the results of analyses that have since been cancelled
+    if (!m_busy) {
+        return;
+    }
+
+    m_analysis = m_watcher.result();
+    m_stopped.reset();
+
+    setBusy(false);
+
+    emit analysisChanged();
+}
+
+void EndgameSolver::setBusy(bool busy)
+{
+    if (busy == m_busy) {
+        return;
+    }
+
+    m_busy = busy;
+
+    emit busyChanged();
+}
+
+int EndgameSolver::negamax(
+    Context &context,
+    std::vector<std::unique_ptr<GameEngine>> &positions,
+    int ply,
+    const GameEngine &position,
+    int player,
+    int alpha,
+    int beta)
+{
+    if (context.aborted || context.stopped()) {
+        context.aborted = true;
+
+        return 0;
+    }
+
+    if (position.stage() == GameEngine::EndStage) {
+        return scoreDifference(position, player);
+    }
+
+    const quint64 key = memoKey(position);
+    QPoint memoMove(-1, -1);
+
+    {
+        QMutexLocker locker(&context.mutex);
+
+        const auto it = context.memo.find(key);
+
+        if (it != context.memo.end()) {
+            const Entry entry = it->second;
+
+            locker.unlock();
+
+            memoMove = position.fromCanonical(QPoint(entry.moveX, entry.moveY));
+
+            if (entry.bound == ExactBound) {
+                return entry.value;
+            } else if (entry.bound == LowerBound) {
+                alpha = std::max(alpha, entry.value);
+            } else {
+                beta = std::min(beta, entry.value);
+            }
+
+            if (alpha >= beta) {
+                return entry.value;
+            }
+        }
+    }
+
+    const int originalAlpha = alpha;
+    const int nextPlayer = (player + 1) % position.numPlayers();
+    const std::vector<QPoint> moves = findMoves(position, memoMove);
+    int bestValue = -INFINITE_VALUE;
+    QPoint bestMove = moves.front();
+
+    // the children at each ply share an engine, made the first time the
+    // worker reaches the ply
+    if (static_cast<int>(positions.size()) == ply) {
+        positions.emplace_back(new GameEngine());
+    }
+
+    for (const QPoint &move : moves) {
+        GameEngine &child = *positions[ply];
+
+        child.copyGame(position);
+        makeMove(child, move);
+
+        const int value = -negamax(
+            context, positions, ply + 1, child, nextPlayer, -beta, -alpha);
+
+        if (context.aborted) {
+            return 0;
+        }
+
+        if (value > bestValue) {
+            bestValue = value;
+            bestMove = move;
+        }
+
+        alpha = std::max(alpha, value);
+
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    const QPoint memoBestMove = position.toCanonical(bestMove);
+    QMutexLocker locker(&context.mutex);
+
+    context.memo[key] = {
+        bestValue,
+        static_cast<qint16>(memoBestMove.x()),
+        static_cast<qint16>(memoBestMove.y()),
+        bestValue <= originalAlpha
+            ? UpperBound
+            : bestValue >= beta ? LowerBound : ExactBound};
+
+    return bestValue;
+}
+
+std::vector<QPoint> EndgameSolver::findMoves(
+    const GameEngine &position,
+    const QPoint &firstMove)
+{
+    const int rows = position.rows();
+    const int columns = position.columns();
+    const quint64 rowMask = columns + 1 == 64
+        ? ~Q_UINT64_C(0)
+        : (Q_UINT64_C(1) << (columns + 1)) - 1;
+    std::vector<quint64> reach(rows + 1, 0);
+    std::vector<quint64> spread(rows + 1, 0);
+
+    for (const Dot *dot : position.getDots()) {
+        if (dot->isActive()) {
+            reach[dot->y()] |= Q_UINT64_C(1) << dot->x();
+        }
+    }
+
+    // grow the dots by one point in every direction for each placement the
+    // player has left, this turn's included
+    for (int i = 0; i < position.turnsLeft(); ++i) {
+        for (int y = 0; y <= rows; ++y) {
+            spread[y] = (reach[y] | reach[y] << 1 | reach[y] >> 1) & rowMask;
+        }
+
+        for (int y = 0; y <= rows; ++y) {
+            reach[y] = spread[y] | (y > 0 ? spread[y - 1] : 0)
+                | (y < rows ? spread[y + 1] : 0);
+        }
+    }
+
+    QBitArray threatenedPoints((rows + 1) * (columns + 1), false);
+    std::vector<QPoint> moves;
+    std::vector<QPoint> quietMoves;
+    QPoint farMove(-1, -1);
+
+    for (int i = 0; i < position.numPlayers(); ++i) {
+        threatenedPoints |= position.threatenedPoints(i);
+    }
+
+    if (position.canPlaceDot(firstMove.x(), firstMove.y())) {
+        moves.push_back(firstMove);
+    }
+
+    for (int y = 0; y <= rows; ++y) {
+        for (int x = 0; x <= columns; ++x) {
+            const QPoint point(x, y);
+
+            if (point == firstMove || !position.canPlaceDot(x, y)) {
+                continue;
+            }
+
+            // the points that may be captured are tried first, as they are
+            // the likeliest to decide the outcome
+            if ((reach[y] >> x & 1) == 0) {
+                // the first far point stands for the others, which is not
+                // exact when some of them lie inside a nearly closed wall
+                if (farMove.x() < 0) {
+                    farMove = point;
+                }
+            } else if (threatenedPoints.testBit(y * (columns + 1) + x)) {
+                moves.push_back(point);
+            } else {
+                quietMoves.push_back(point);
+            }
+        }
+    }
+
+    moves.insert(moves.end(), quietMoves.begin(), quietMoves.end());
+
+    if (farMove.x() >= 0) {
+        moves.push_back(farMove);
+    }
+
+    // with nowhere left to place a dot, the turn is passed
+    if (moves.empty()) {
+        moves.push_back(QPoint(-1, -1));
+    }
+
+    return moves;
+}
+
+void EndgameSolver::makeMove(GameEngine &engine, const QPoint &move)
+{
+    if (engine.placeDot(move.x(), move.y())) {
+        engine.connectAllDots();
+    }
+
+    engine.endTurn();
+}
+
+quint64 EndgameSolver::memoKey(const GameEngine &position)
+{
+    // the orientations of a position share an entry, which holds the move in
+    // the canonical orientation; the key leaves out the number of turns left
+    return position.canonicalKey()
+        ^ static_cast<quint64>(position.turnsLeft())
+        * Q_UINT64_C(0x9e3779b97f4a7c15);
+}
+
+int EndgameSolver::scoreDifference(const GameEngine &position, int player)
+{
+    const QVariantList scores = position.playerScores();
+    int difference = 0;
+
+    for (int i = 0; i < position.numPlayers(); ++i) {
+        difference += (i == player ? 1 : -1) * scores.at(i).toInt();
+    }
+
+    return difference;
+}
@@ -0,0 +1,160 @@
+#ifndef ENDGAMESOLVER_H
+#define ENDGAMESOLVER_H
+
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QObject>
+#include <QPoint>
+#include <QVariantList>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class GameEngine;
+
+/// Finds the outcome of the best play it can see once few turns are left.
+///
+/// Each turn is taken as a dot placed with all its connections made, as the
+/// computer player plays it. Every placement within reach of the dots is
+/// searched, but of the points farther from every dot than the player has
+/// placements left, only the first stands for all of them. Such a dot can
+/// neither join a wall nor be walled in by new dots, though it may still be
+/// captured if it lies inside a wall that is nearly closed already. The
+/// result is therefore exact only when no far point lies in such a wall. The
+/// placements near the dots are found on bitboards of the board rows, the
+/// results are memoised by position and the root moves are shared out over
+/// the global thread pool.
+///
+/// The solver also keeps the position in which the end of the game came
+/// within its reach, so that the game can be analysed once it is over.
+class EndgameSolver : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(GameEngine *engine READ engine WRITE setEngine)
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+    Q_PROPERTY(bool analysed READ isAnalysed NOTIFY analysisChanged)
+    Q_PROPERTY(int analysedPlayer READ analysedPlayer NOTIFY analysisChanged)
+    Q_PROPERTY(
+        int analysedDifference READ analysedDifference NOTIFY analysisChanged)
+    Q_PROPERTY(
+        QVariantList analysedLine READ analysedLine NOTIFY analysisChanged)
+    Q_PROPERTY(int maxTurns READ maxTurns CONSTANT)
+
+public:
+    struct Solution
+    {
+        /// False if the position is out of reach or the search was stopped.
+        bool solved = false;
+        /// The player to move, whose view the score difference is from.
+        int player = -1;
+        /// The player's final score minus those of the other players.
+        int scoreDifference = 0;
+        /// The placements of the best line found, one per turn.
+        std::vector<QPoint> line;
+    };
+
+    explicit EndgameSolver(QObject *parent = nullptr);
+    ~EndgameSolver() override;
+
+    GameEngine *engine() const;
+    void setEngine(GameEngine *engine);
+
+    bool isBusy() const;
+
+    /// Checks if the analysis of the last game is available.
+    bool isAnalysed() const;
+    int analysedPlayer() const;
+    int analysedDifference() const;
+
+    /// Gets the placements of the analysed line as points.
+    QVariantList analysedLine() const;
+
+    /// Gets the number of turns left from which positions are solved.
+    int maxTurns() const;
+
+    /// Checks if the position is near enough to the end to be solved.
+    static bool canSolve(const GameEngine &position);
+
+    /// Solves the position, from the start of the current player's turn.
+    ///
+    /// Blocks until the solution is found or stopped() returns true, which is
+    /// checked between placements from any thread.
+    ///
+    /// \returns the solution, unsolved if the position cannot be solved or
+    /// the search was stopped.
+    static Solution solve(
+        const GameEngine &position,
+        const std::function<bool()> &stopped);
+
+public slots:
+    /// Starts solving the position in which the end of the game came within
+    /// reach, cancelling any previous analysis. The result is given by
+    /// analysedDifference() and analysedLine() once analysed is set.
+    void analyse();
+    void cancel();
+
+signals:
+    void busyChanged();
+    void analysisChanged();
+
+private:
+    enum Bound : quint8
+    {
+        ExactBound,
+        LowerBound,
+        UpperBound
+    };
+
+    struct Entry
+    {
+        int value;
+        qint16 moveX;
+        qint16 moveY;
+        Bound bound;
+    };
+
+    /// The state shared by the workers of a solve.
+    struct Context
+    {
+        std::function<bool()> stopped;
+        std::atomic<bool> aborted;
+        std::atomic<int> rootAlpha;
+        QMutex mutex;
+        std::unordered_map<quint64, Entry> memo;
+    };
+
+    void watchPosition();
+    void finishAnalysis();
+    void setBusy(bool busy);
+
+    static int negamax(
+        Context &context,
+        std::vector<std::unique_ptr<GameEngine>> &positions,
+        int ply,
+        const GameEngine &position,
+        int player,
+        int alpha,
+        int beta);
+    static std::vector<QPoint> findMoves(
+        const GameEngine &position,
+        const QPoint &firstMove);
+    static void makeMove(GameEngine &engine, const QPoint &move);
+    static quint64 memoKey(const GameEngine &position);
+    static int scoreDifference(const GameEngine &position, int player);
+
+    static const int MAX_TURNS = 2;
+    static const int MAX_COLUMNS = 63;
+    static const int INFINITE_VALUE = 1 << 29;
+
+    GameEngine *m_engine;
+    std::shared_ptr<GameEngine> m_analysisPosition;
+    std::shared_ptr<std::atomic<bool>> m_stopped;
+    QFutureWatcher<Solution> m_watcher;
+    bool m_busy;
+    Solution m_analysis;
+};
+
+#endif // ENDGAMESOLVER_H
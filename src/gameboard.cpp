@@ -1,26 +1,92 @@
 #include "gameboard.h"
+#include "dotimagecache.h"
+#include "dotmaterial.h"
 #include "gameengine.h"
+#include "gridmaterial.h"
+#include "instrumentation.h"
 #include "line.h"
+#include "linematerial.h"
+#include "materialcache.h"
+#include "rendersnapshot.h"
 #include "stroke.h"
-#include <QPainter>
+#include "tracing.h"
+#include <QLineF>
+#include <QMatrix4x4>
 #include <QQuickWindow>
 #include <QSGFlatColorMaterial>
-#include <QSGImageNode>
+#include <QSGRendererInterface>
+#include <QSGSimpleRectNode>
+#include <QSGSimpleTextureNode>
+#include <QSGVertexColorMaterial>
+#include <QtConcurrent>
 #include <algorithm>
+#include <cstring>
 #include <limits>
 
-GameBoard::QSGGameBoardNode::QSGGameBoardNode()
+namespace
+{
+    /// Checks if the two dots are consecutive in the chain.
+    bool hasSegment(
+        const std::deque<Dot> &chain,
+        const Dot &dot1,
+        const Dot &dot2)
+    {
+        return std::adjacent_find(
+                   chain.begin(),
+                   chain.end(),
+                   [&](const Dot &current, const Dot &next) {
+                       return (current == dot1 && next == dot2)
+                           || (current == dot2 && next == dot1);
+                   })
+            != chain.end();
+    }
+}
+
+GameBoard::QSGTileNode::QSGTileNode()
     : QSGNode()
+    , m_culled(false)
+{
+}
+
+bool GameBoard::QSGTileNode::isCulled() const
+{
+    return m_culled;
+}
+
+void GameBoard::QSGTileNode::setCulled(bool culled)
+{
+    if (culled == m_culled) {
+        return;
+    }
+
+    m_culled = culled;
+
+    markDirty(QSGNode::DirtySubtreeBlocked);
+}
+
+bool GameBoard::QSGTileNode::isSubtreeBlocked() const
+{
+    return m_culled;
+}
+
+GameBoard::QSGGameBoardNode::QSGGameBoardNode(QQuickWindow *window)
+    : QSGTransformNode()
+    , m_window(window)
     , m_gridNode(new QSGGeometryNode())
+    , m_overviewNode(new QSGGeometryNode())
+    , m_legalMoveNode(new QSGGeometryNode())
+    , m_threatNode(new QSGGeometryNode())
     , m_dotContainerNode(new QSGNode())
     , m_lineContainerNode(new QSGNode())
     , m_chainContainerNode(new QSGNode())
     , m_provisionalDotContainerNode(new QSGOpacityNode())
     , m_provisionalChainContainerNode(new QSGOpacityNode())
-    , m_dotTextures(QVector<QSGTexture *>(DEFAULT_NUM_PLAYERS))
-    , m_lineMaterials(QVector<QSGMaterial *>(DEFAULT_NUM_PLAYERS))
+    , m_lineMaterials(QVector<LineMaterial *>(DEFAULT_NUM_PLAYERS))
 {
     appendChildNode(m_gridNode);
+    appendChildNode(m_overviewNode);
+    appendChildNode(m_legalMoveNode);
+    appendChildNode(m_threatNode);
     appendChildNode(m_dotContainerNode);
     appendChildNode(m_lineContainerNode);
     appendChildNode(m_chainContainerNode);
@@ -30,13 +96,8 @@ GameBoard::QSGGameBoardNode::QSGGameBoardNode()
 
 GameBoard::QSGGameBoardNode::~QSGGameBoardNode()
 {
-    for (const QSGTexture *dotTexture : m_dotTextures) {
-        delete dotTexture;
-    }
-
-    for (const QSGMaterial *lineMaterial : m_lineMaterials) {
-        delete lineMaterial;
-    }
+    setDotMaterials(QVector<DotMaterial *>());
+    setDotTextures(QVector<QSGTexture *>());
 }
 
 QSGGeometryNode *GameBoard::QSGGameBoardNode::gridNode() const
@@ -44,6 +105,21 @@ QSGGeometryNode *GameBoard::QSGGameBoardNode::gridNode() const
     return m_gridNode;
 }
 
+QSGGeometryNode *GameBoard::QSGGameBoardNode::overviewNode() const
+{
+    return m_overviewNode;
+}
+
+QSGGeometryNode *GameBoard::QSGGameBoardNode::legalMoveNode() const
+{
+    return m_legalMoveNode;
+}
+
+QSGGeometryNode *GameBoard::QSGGameBoardNode::threatNode() const
+{
+    return m_threatNode;
+}
+
 QSGNode *GameBoard::QSGGameBoardNode::dotContainerNode() const
 {
     return m_dotContainerNode;
@@ -70,6 +146,26 @@ QSGOpacityNode *GameBoard::QSGGameBoardNode::provisionalChainContainerNode()
     return m_provisionalChainContainerNode;
 }
 
+QVector<DotMaterial *> GameBoard::QSGGameBoardNode::dotMaterials() const
+{
+    return m_dotMaterials;
+}
+
+void GameBoard::QSGGameBoardNode::setDotMaterials(
+    QVector<DotMaterial *> dotMaterials)
+{
+    // the new materials are already held, so those shared with the old ones
+    // are not deleted
+    for (DotMaterial *dotMaterial : m_dotMaterials) {
+        QSGTexture *dotTexture = dotMaterial->texture();
+
+        MaterialCache::releaseDotMaterial(m_window, dotMaterial);
+        DotImageCache::releaseTexture(m_window, dotTexture);
+    }
+
+    m_dotMaterials = dotMaterials;
+}
+
 QVector<QSGTexture *> GameBoard::QSGGameBoardNode::dotTextures() const
 {
     return m_dotTextures;
@@ -78,46 +174,90 @@ QVector<QSGTexture *> GameBoard::QSGGameBoardNode::dotTextures() const
 void GameBoard::QSGGameBoardNode::setDotTextures(
     QVector<QSGTexture *> dotTextures)
 {
+    for (QSGTexture *dotTexture : m_dotTextures) {
+        DotImageCache::releaseTexture(m_window, dotTexture);
+    }
+
     m_dotTextures = dotTextures;
 }
 
-QVector<QSGMaterial *> GameBoard::QSGGameBoardNode::lineMaterials() const
+QVector<LineMaterial *> GameBoard::QSGGameBoardNode::lineMaterials() const
 {
     return m_lineMaterials;
 }
 
 void GameBoard::QSGGameBoardNode::setLineMaterials(
-    QVector<QSGMaterial *> lineMaterials)
+    QVector<LineMaterial *> lineMaterials)
 {
     m_lineMaterials = lineMaterials;
 }
 
+QVector<GameBoard::QSGTileNode *> &GameBoard::QSGGameBoardNode::dotTileNodes()
+{
+    return m_dotTileNodes;
+}
+
+QVector<GameBoard::QSGTileNode *> &GameBoard::QSGGameBoardNode::lineTileNodes()
+{
+    return m_lineTileNodes;
+}
+
 GameBoard::GameBoard(QQuickItem *parent)
     : QQuickItem(parent)
     , m_engine(nullptr)
     , m_numPlayers(DEFAULT_NUM_PLAYERS)
     , m_gridStroke(new Stroke())
     , m_gridRotation(0)
+    , m_gridSize(0)
+    , m_dotImagesGeneration(0)
+    , m_pendingDotImagesGeneration(0)
+    , m_legalMovesVisible(false)
+    , m_threatsVisible(false)
+    , m_provisionalSnapshot(std::make_shared<ProvisionalSnapshot>())
+    , m_legalMovesVersion(0)
+    , m_threatsVersion(0)
+    , m_transformDirty(true)
     , m_gridDirty(true)
     , m_dotsDirty(true)
     , m_dotImagesDirty(true)
     , m_linesDirty(true)
+    , m_chainsDirty(true)
+    , m_provisionalDirty(true)
     , m_lineMaterialsDirty(true)
+    , m_viewportDirty(true)
+    , m_legalMovesDirty(true)
+    , m_threatsDirty(true)
 {
     setFlag(ItemHasContents, true);
     connect(this, &GameBoard::widthChanged, this, &GameBoard::resizeBoard);
     connect(this, &GameBoard::heightChanged, this, &GameBoard::resizeBoard);
+    connect(this, &GameBoard::hasPendingMovesChanged, [&] {
+        publishProvisionalSnapshot();
+
+        m_provisionalDirty = true;
+
+        drawBoard();
+    });
     connect(
-        this, &GameBoard::hasPendingMovesChanged, this, &GameBoard::drawBoard);
+        &m_dotImagesWatcher, &QFutureWatcher<QVector<QImage>>::finished, [&] {
+            // discard images of sources that have since been superseded
+            if (m_pendingDotImagesGeneration == m_dotImagesGeneration) {
+                setDotImages(m_dotImagesWatcher.result());
+            }
+        });
 }
 
 GameBoard::~GameBoard()
 {
-    delete m_gridStroke;
+    if (m_engine != nullptr) {
+        if (m_threatsVisible) {
+            m_engine->releaseThreats();
+        }
 
-    for (const QSvgRenderer *dotSvgRenderer : m_dotSvgRenderers) {
-        delete dotSvgRenderer;
+        m_engine->releaseRenderSnapshot();
     }
+
+    delete m_gridStroke;
 }
 
 GameEngine *GameBoard::engine() const
@@ -133,11 +273,29 @@ void GameBoard::setEngine(GameEngine *engine)
 
     if (m_engine != nullptr) {
         m_engine->disconnect(this);
+
+        if (m_threatsVisible) {
+            m_engine->releaseThreats();
+        }
+
+        m_engine->releaseRenderSnapshot();
     }
 
+    m_engine = engine;
+
     if (engine != nullptr) {
-        m_engine = engine;
         m_numPlayers = engine->numPlayers();
+        m_engine->retainRenderSnapshot();
+
+        if (m_threatsVisible) {
+            m_engine->retainThreats();
+        }
+
+        // an engine may be destroyed before the board, which must then not
+        // release its snapshots
+        connect(m_engine, &QObject::destroyed, this, [this] {
+            m_engine = nullptr;
+        });
 
         connect(
             m_engine, &GameEngine::gameStarted, this, &GameBoard::setUpBoard);
@@ -146,10 +304,14 @@ void GameBoard::setEngine(GameEngine *engine)
 
             drawBoard();
         });
-        connect(
-            m_engine, &GameEngine::chainsChanged, this, &GameBoard::drawBoard);
+        connect(m_engine, &GameEngine::chainsChanged, [&] {
+            m_chainsDirty = true;
+
+            drawBoard();
+        });
         connect(m_engine, &GameEngine::linesChanged, [&] {
             m_linesDirty = true;
+            m_chainsDirty = true;
 
             drawBoard();
         });
@@ -170,20 +332,15 @@ QVariantList GameBoard::dotSources() const
 
 void GameBoard::setDotSources(QVariantList &list)
 {
-    m_dotSources = list;
-
-    if (list.size() == m_numPlayers) {
-        for (int i = 0; i < m_dotSvgRenderers.size(); ++i) {
-            delete m_dotSvgRenderers[i];
-        }
+    if (list == m_dotSources) {
+        return;
+    }
 
-        m_dotSvgRenderers.resize(m_numPlayers);
+    m_dotSources = list;
 
-        for (int i = 0; i < m_numPlayers; ++i) {
-            QString fileString = list[i].toString();
-            fileString.replace("qrc", "");
-            m_dotSvgRenderers[i] = new QSvgRenderer(fileString);
-        }
+    // before the board is set up, setUpBoard() makes the images
+    if (isReady()) {
+        makeDotImages();
     }
 }
 
@@ -239,6 +396,75 @@ bool GameBoard::hasPendingMoves() const
     }
 }
 
+QRectF GameBoard::viewport() const
+{
+    return m_viewport;
+}
+
+void GameBoard::setViewport(const QRectF &viewport)
+{
+    if (viewport == m_viewport) {
+        return;
+    }
+
+    m_viewport = viewport;
+    m_viewportDirty = true;
+
+    emit viewportChanged();
+
+    update();
+}
+
+bool GameBoard::legalMovesVisible() const
+{
+    return m_legalMovesVisible;
+}
+
+void GameBoard::setLegalMovesVisible(bool visible)
+{
+    if (visible == m_legalMovesVisible) {
+        return;
+    }
+
+    m_legalMovesVisible = visible;
+    m_legalMovesDirty = true;
+
+    // the connectable dots are only found while the overlay is visible
+    publishProvisionalSnapshot();
+
+    emit legalMovesVisibleChanged();
+
+    update();
+}
+
+bool GameBoard::threatsVisible() const
+{
+    return m_threatsVisible;
+}
+
+void GameBoard::setThreatsVisible(bool visible)
+{
+    if (visible == m_threatsVisible) {
+        return;
+    }
+
+    m_threatsVisible = visible;
+    m_threatsDirty = true;
+
+    // the engine only works out the threats while a board shows them
+    if (m_engine != nullptr) {
+        if (visible) {
+            m_engine->retainThreats();
+        } else {
+            m_engine->releaseThreats();
+        }
+    }
+
+    emit threatsVisibleChanged();
+
+    update();
+}
+
 void GameBoard::markPosition(QPoint point)
 {
     if (!isReady()) {
@@ -251,14 +477,10 @@ void GameBoard::markPosition(QPoint point)
         return;
     }
 
-    const QTransform gridTransform = QTransform().rotate(-m_gridRotation);
-
-    const QRectF grid = gridTransform.mapRect(m_gridRect);
-    point = gridTransform.map(point);
-
-    const QPointF gridOrigin = grid.topLeft();
-    int row = static_cast<int>((point.y() - gridOrigin.y()) / m_gridSize);
-    int col = static_cast<int>((point.x() - gridOrigin.x()) / m_gridSize);
+    const QPointF boardPoint =
+        gridDisplayTransform().inverted().map(QPointF(point));
+    int row = static_cast<int>(boardPoint.y() / m_gridSize);
+    int col = static_cast<int>(boardPoint.x() / m_gridSize);
 
     Dot dot;
     QPointF intersections[2][2];
@@ -274,7 +496,7 @@ void GameBoard::markPosition(QPoint point)
     for (int i = 0; i < 2; ++i) {
         for (int j = 0; j < 2; ++j) {
             const qreal distance =
-                (intersections[i][j] - point).manhattanLength();
+                (intersections[i][j] - boardPoint).manhattanLength();
 
             if (nearestIntersection == nullptr || distance < shortestDistance) {
                 dot = Dot(m_engine->currentPlayer(), col + j, row + i);
@@ -284,6 +506,17 @@ void GameBoard::markPosition(QPoint point)
         }
     }
 
+    markIntersection(dot.x(), dot.y());
+}
+
+void GameBoard::markIntersection(int x, int y)
+{
+    if (!isReady()) {
+        return;
+    }
+
+    const Dot dot(m_engine->currentPlayer(), x, y);
+
     switch (m_engine->stage()) {
         case GameEngine::PlaceDotStage:
             if (m_engine->canPlaceDot(dot.x(), dot.y())) {
@@ -352,14 +585,18 @@ void GameBoard::setUpBoard()
         return;
     }
 
+    m_gridDirty = true;
     m_lineMaterialsDirty = true;
 
+    makeDotImages();
     resizeBoard();
     clearProvisional();
 }
 
 void GameBoard::resizeBoard()
 {
+    TRACE_SPAN("GameBoard::resizeBoard");
+
     if (!isReady()) {
         return;
     }
@@ -381,17 +618,26 @@ void GameBoard::resizeBoard()
         m_gridRotation = rows == shorter ? 0 : -90;
     }
 
-    makeGrid();
-    makeDotImages();
+    const qreal oldGridSize = m_gridSize;
 
-    for (Stroke *stroke : m_markStrokes) {
-        stroke->setWidth(m_gridSize * 0.25);
+    layOutGrid();
+
+    // the board content is laid out in its own unrotated frame, so only the
+    // transform needs updating unless the grid squares have changed size
+    if (m_gridDirty || !qFuzzyCompare(m_gridSize, oldGridSize)) {
+        for (Stroke *stroke : m_markStrokes) {
+            stroke->setWidth(m_gridSize * 0.25);
+        }
+
+        m_gridDirty = true;
+        m_dotsDirty = true;
+        m_linesDirty = true;
+        m_chainsDirty = true;
+        m_provisionalDirty = true;
     }
 
-    m_gridDirty = true;
-    m_dotsDirty = true;
-    m_dotImagesDirty = true;
-    m_linesDirty = true;
+    m_transformDirty = true;
+    m_viewportDirty = true;
 
     update();
 }
@@ -405,6 +651,10 @@ void GameBoard::clearProvisional()
 {
     m_provisionalDot = Dot();
     m_provisionalChain.clear();
+    m_chainsDirty = true;
+    m_provisionalDirty = true;
+
+    publishProvisionalSnapshot();
 
     update();
 }
@@ -418,31 +668,73 @@ void GameBoard::componentComplete()
 
 QSGNode *GameBoard::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 {
+    INSTRUMENT_TIME(PaintNodeTime);
+    TRACE_SPAN("GameBoard::updatePaintNode");
+
     if (!isReady()) {
         return oldNode;
     }
 
     QSGGameBoardNode *node = static_cast<QSGGameBoardNode *>(oldNode);
     if (node == nullptr) {
-        node = new QSGGameBoardNode();
+        node = new QSGGameBoardNode(window());
+
+        // the textures of a previous node may have been released along with
+        // the scene graph
+        m_transformDirty = true;
+        m_gridDirty = true;
+        m_dotsDirty = true;
+        m_dotImagesDirty = true;
+        m_linesDirty = true;
+        m_chainsDirty = true;
+        m_provisionalDirty = true;
+        m_lineMaterialsDirty = true;
+        m_viewportDirty = true;
+        m_legalMovesDirty = true;
+        m_threatsDirty = true;
+    }
+
+    m_renderSnapshot = m_engine->renderSnapshot();
+    m_renderProvisionalSnapshot = std::atomic_load(&m_provisionalSnapshot);
+
+    if (m_transformDirty) {
+        node->setMatrix(QMatrix4x4(gridDisplayTransform()));
+
+        m_transformDirty = false;
     }
 
-    prepareDotTextures(node);
+    prepareDotMaterials(node);
     prepareLineMaterials(node);
 
-    m_dotImagesDirty = false;
     m_lineMaterialsDirty = false;
 
     updateGridNode(node);
+    updateOverviewNode(node);
+    updateLegalMoveNode(node);
+    updateThreatNode(node);
     updateDotContainerNode(node);
     updateLineContainerNode(node);
     updateChainContainerNode(node);
     updateProvisionalDotContainerNode(node);
     updateProvisionalChainContainerNode(node);
+    updateTileNodes(node);
 
     m_gridDirty = false;
     m_dotsDirty = false;
+    m_dotImagesDirty = false;
     m_linesDirty = false;
+    m_chainsDirty = false;
+    m_provisionalDirty = false;
+    m_viewportDirty = false;
+    m_legalMovesDirty = false;
+    m_threatsDirty = false;
+
+    INSTRUMENT_SET(DotTileCount, node->dotContainerNode()->childCount());
+    INSTRUMENT_SET(LineTileCount, node->lineContainerNode()->childCount());
+    INSTRUMENT_SET(ChainNodeCount, node->chainContainerNode()->childCount());
+
+    m_renderSnapshot.reset();
+    m_renderProvisionalSnapshot.reset();
 
     return node;
 }
@@ -469,7 +761,7 @@ void GameBoard::clearMarkStrokes(QQmlListProperty<Stroke> *property)
     static_cast<GameBoard *>(property->object)->clearMarkStrokes();
 }
 
-void GameBoard::makeGrid()
+void GameBoard::layOutGrid()
 {
     QRectF rect = boundingRect();
 
@@ -483,41 +775,105 @@ void GameBoard::makeGrid()
     qreal width = m_gridColumns * m_gridSize;
     qreal height = m_gridRows * m_gridSize;
     qreal left = rect.left() + (rect.width() - width) / 2;
-    qreal right = left + width + 1;
     qreal top = rect.top() + (rect.height() - height) / 2;
-    qreal bottom = top + height + 1;
 
     m_gridRect = QRectF(left, top, width, height);
+}
 
-    m_gridLines.clear();
+void GameBoard::makeDotImages()
+{
+    TRACE_SPAN("GameBoard::makeDotImages");
 
-    for (qreal x = left; x <= right; x += m_gridSize) {
-        m_gridLines.append(QLineF(x, top, x, bottom));
+    const int numPlayers = m_numPlayers;
+    QStringList dotSources;
+    QVector<QImage> dotImages;
+
+    for (int i = 0; i < numPlayers; ++i) {
+        const QString dotSource = m_dotSources.value(i).toString();
+        const QImage dotImage = DotImageCache::cachedDistanceField(dotSource);
+
+        dotSources.append(dotSource);
+
+        if (!dotImage.isNull()) {
+            dotImages.append(dotImage);
+        }
     }
-    for (qreal y = top; y <= bottom; y += m_gridSize) {
-        m_gridLines.append(QLineF(left, y, right, y));
+
+    ++m_dotImagesGeneration;
+
+    if (dotImages.size() == numPlayers) {
+        setDotImages(dotImages);
+
+        return;
     }
+
+    // rasterise off the GUI thread; the current images are drawn until the
+    // new ones are ready
+    m_pendingDotImagesGeneration = m_dotImagesGeneration;
+    m_dotImagesWatcher.setFuture(QtConcurrent::run([=] {
+        QVector<QImage> images;
+
+        for (const QString &dotSource : dotSources) {
+            images.append(DotImageCache::distanceField(dotSource));
+        }
+
+        return images;
+    }));
 }
 
-void GameBoard::makeDotImages()
+void GameBoard::setDotImages(const QVector<QImage> &dotImages)
 {
-    QPainter dotPainter;
+    m_dotImages = dotImages;
+    m_dotImagesDirty = true;
+    m_dotsDirty = true;
+    m_provisionalDirty = true;
 
-    m_dotImages.resize(m_numPlayers);
+    update();
+}
 
-    for (int i = 0; i < m_numPlayers; ++i) {
-        QImage &dotImage = m_dotImages[i];
-        dotImage = QImage(
-            QSize(
-                static_cast<int>(m_gridSize * 0.5),
-                static_cast<int>(m_gridSize * 0.5)),
-            QImage::Format_ARGB32_Premultiplied);
-        dotImage.fill(qRgba(0, 0, 0, 0));
-        dotPainter.begin(&dotImage);
-        dotPainter.setRenderHint(QPainter::Antialiasing, true);
-        m_dotSvgRenderers[i]->render(&dotPainter);
-        dotPainter.end();
+void GameBoard::publishProvisionalSnapshot()
+{
+    std::shared_ptr<ProvisionalSnapshot> snapshot =
+        std::make_shared<ProvisionalSnapshot>();
+
+    snapshot->dot = m_provisionalDot;
+    snapshot->chain.assign(
+        m_provisionalChain.begin(), m_provisionalChain.end());
+
+    if (m_legalMovesVisible && isReady()
+        && m_engine->stage() == GameEngine::ConnectDotsStage
+        && !m_provisionalChain.empty()) {
+        std::vector<Dot> &connectableDots = snapshot->connectableDots;
+
+        // only the ends can be extended, and by at most eight neighbours each
+        for (const Dot *end :
+             {&m_provisionalChain.front(), &m_provisionalChain.back()}) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const Dot *dot =
+                        m_engine->getDotAt(end->x() + dx, end->y() + dy);
+
+                    if (dot == nullptr
+                        || std::find(
+                               connectableDots.begin(),
+                               connectableDots.end(),
+                               *dot)
+                            != connectableDots.end()) {
+                        continue;
+                    }
+
+                    if (m_engine->canConnectDots(*end, *dot)
+                        && !hasSegment(m_provisionalChain, *end, *dot)) {
+                        connectableDots.push_back(*dot);
+                    }
+                }
+            }
+        }
     }
+
+    std::atomic_store(
+        &m_provisionalSnapshot,
+        std::shared_ptr<const ProvisionalSnapshot>(std::move(snapshot)));
 }
 
 void GameBoard::tryAddToChain(const Dot &dot)
@@ -537,50 +893,201 @@ void GameBoard::tryAddToChain(const Dot &dot)
         return;
     }
 
-    const Dot &first = m_provisionalChain.front();
-    const Dot &last = m_provisionalChain.back();
-    const Dot *previousDot = nullptr;
+    const Dot first = m_provisionalChain.front();
+    const Dot last = m_provisionalChain.back();
+
+    // extend the chain directly if the dot neighbours one of its ends
+    for (const Dot &end : {last, first}) {
+        if (dot.isNeighbor(end) && !hasSegment(m_provisionalChain, end, dot)
+            && m_engine->canConnectDots(end, dot)) {
+            if (end == last) {
+                m_provisionalChain.push_back(dot);
+            } else {
+                m_provisionalChain.push_front(dot);
+            }
+
+            emit hasPendingMovesChanged();
+
+            return;
+        }
+    }
 
-    if (dot.isNeighbor(first)) {
-        previousDot = &first;
-    } else if (dot.isNeighbor(last)) {
-        previousDot = &last;
+    // otherwise route the shortest legal path to the dot from the nearer end,
+    // without passing through the chain
+    const std::vector<Dot> chain(
+        m_provisionalChain.begin(), m_provisionalChain.end());
+    const std::vector<Dot> pathFromLast =
+        m_engine->findConnectionPath(last, dot, chain);
+    const std::vector<Dot> pathFromFirst = first == last
+        ? std::vector<Dot>()
+        : m_engine->findConnectionPath(first, dot, chain);
+
+    if (!pathFromLast.empty()
+        && (pathFromFirst.empty()
+            || pathFromLast.size() <= pathFromFirst.size())) {
+        m_provisionalChain.insert(
+            m_provisionalChain.end(),
+            pathFromLast.begin() + 1,
+            pathFromLast.end());
+    } else if (!pathFromFirst.empty()) {
+        m_provisionalChain.insert(
+            m_provisionalChain.begin(),
+            pathFromFirst.rbegin(),
+            pathFromFirst.rend() - 1);
+    } else if (dot.isNeighbor(first) || dot.isNeighbor(last)) {
+        return;
     } else {
         m_provisionalChain.clear();
         m_provisionalChain.push_back(dot);
+    }
 
-        emit hasPendingMovesChanged();
+    emit hasPendingMovesChanged();
+}
 
-        return;
-    }
+QPointF GameBoard::findIntersection(int x, int y) const
+{
+    return QPointF(x * m_gridSize, y * m_gridSize);
+}
+
+qreal GameBoard::findDotTexelSize() const
+{
+    const qreal dotSize = m_gridSize * 0.5;
 
-    std::deque<Dot *> chain;
-    std::deque<Dot>::iterator it;
-    std::deque<Dot>::iterator end = m_provisionalChain.end();
+    return dotSize / DotImageCache::DISTANCE_FIELD_SIZE;
+}
 
-    for (it = m_provisionalChain.begin(); it != end; ++it) {
-        chain.push_back(&*it);
-    }
+QRectF GameBoard::findDotRect(int x, int y) const
+{
+    const QPointF intersection = findIntersection(x, y);
+    const qreal dotSize = m_gridSize * 0.5;
+
+    return QRectF(
+        intersection - QPointF(dotSize * 0.5, dotSize * 0.5),
+        QSizeF(dotSize, dotSize));
+}
+
+QSGSimpleTextureNode *GameBoard::makeDotTextureNode(
+    const Dot &dot,
+    QSGTexture *texture) const
+{
+    QSGSimpleTextureNode *dotNode = new QSGSimpleTextureNode();
+
+    dotNode->setTexture(texture);
+    dotNode->setFiltering(QSGTexture::Linear);
+    dotNode->setRect(findDotRect(dot.x(), dot.y()));
+
+    return dotNode;
+}
+
+QSGNode *GameBoard::makeChainNode(
+    const std::vector<QPointF> &points,
+    LineMaterial *material,
+    qreal width) const
+{
+    const int count = qMax(0, static_cast<int>(points.size()) - 1);
+
+    if (!hasShaderMaterials()) {
+        QSGNode *chainNode = new QSGNode();
 
-    if (!m_engine->neighborsInChain(
-            chain.begin(), chain.end() - 1, *previousDot, dot)
-        && m_engine->canConnectDots(*previousDot, dot)) {
-        if (previousDot == &first) {
-            m_provisionalChain.push_front(dot);
-        } else if (previousDot == &last) {
-            m_provisionalChain.push_back(dot);
+        for (int i = 0; i < count; ++i) {
+            chainNode->appendChildNode(makeSegmentNode(
+                points[i], points[i + 1], width, material->color()));
         }
 
-        emit hasPendingMovesChanged();
+        return chainNode;
     }
+
+    // a chain may run around a large part of the board, so its indices are
+    // 32-bit
+    QSGGeometryNode *chainNode = new QSGGeometryNode();
+    QSGGeometry *chainGeometry = new QSGGeometry(
+        LineMaterial::attributes(),
+        count * LineMaterial::SEGMENT_VERTEX_COUNT,
+        count * LineMaterial::SEGMENT_INDEX_COUNT,
+        QSGGeometry::UnsignedIntType);
+    chainGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+    chainNode->setGeometry(chainGeometry);
+    chainNode->setFlag(QSGNode::OwnsGeometry);
+    chainNode->setMaterial(material);
+
+    LineMaterial::Vertex *vertices =
+        static_cast<LineMaterial::Vertex *>(chainGeometry->vertexData());
+    quint32 *indices = chainGeometry->indexDataAsUInt();
+
+    for (int i = 0; i < count; ++i) {
+        LineMaterial::appendSegmentIndices(
+            indices, i * LineMaterial::SEGMENT_VERTEX_COUNT);
+        LineMaterial::appendSegment(
+            vertices, points[i], points[i + 1], width);
+    }
+
+    return chainNode;
 }
 
-QPointF GameBoard::findIntersection(int x, int y) const
+QSGTransformNode *GameBoard::makeSegmentNode(
+    const QPointF &point1,
+    const QPointF &point2,
+    qreal width,
+    const QColor &color) const
 {
-    QRectF grid = QTransform().rotate(-m_gridRotation).mapRect(m_gridRect);
-    QPointF gridOrigin = grid.topLeft();
+    // the segment is laid along the x-axis from its first endpoint, with
+    // square ends reaching past both endpoints by half the width
+    const QLineF line(point1, point2);
+    QSGTransformNode *segmentNode = new QSGTransformNode();
+    QMatrix4x4 matrix;
+
+    matrix.translate(
+        static_cast<float>(point1.x()), static_cast<float>(point1.y()));
+    matrix.rotate(static_cast<float>(-line.angle()), 0, 0, 1);
+    segmentNode->setMatrix(matrix);
+    segmentNode->appendChildNode(new QSGSimpleRectNode(
+        QRectF(-width * 0.5, -width * 0.5, line.length() + width, width),
+        color));
+
+    return segmentNode;
+}
+
+int GameBoard::findTileColumnCount() const
+{
+    return m_renderSnapshot->columns / TILE_SIZE + 1;
+}
 
-    return QPointF(x * m_gridSize, y * m_gridSize) + gridOrigin;
+int GameBoard::findTileIndex(int x, int y) const
+{
+    return y / TILE_SIZE * findTileColumnCount() + x / TILE_SIZE;
+}
+
+QRectF GameBoard::findTileRect(int index) const
+{
+    const int tileColumnCount = findTileColumnCount();
+    const int left = index % tileColumnCount * TILE_SIZE;
+    const int top = index / tileColumnCount * TILE_SIZE;
+
+    // include the neighbouring grid squares, which the dots and the lines
+    // leaving the tile reach into
+    return QRectF(
+        findIntersection(left - 1, top - 1),
+        findIntersection(left + TILE_SIZE, top + TILE_SIZE));
+}
+
+QRectF GameBoard::findVisibleRect() const
+{
+    const QRectF viewport = m_viewport.isNull() ? boundingRect() : m_viewport;
+
+    return gridDisplayTransform().inverted().mapRect(viewport);
+}
+
+bool GameBoard::isOverview() const
+{
+    return m_gridSize < OVERVIEW_GRID_SIZE;
+}
+
+bool GameBoard::hasShaderMaterials() const
+{
+    // the custom materials only have shaders for the OpenGL renderer, not for
+    // the software renderer or the RHI
+    return window()->rendererInterface()->graphicsApi()
+        == QSGRendererInterface::OpenGL;
 }
 
 bool GameBoard::isReady() const
@@ -591,302 +1098,895 @@ bool GameBoard::isReady() const
 
 void GameBoard::updateGridNode(GameBoard::QSGGameBoardNode *node)
 {
+    INSTRUMENT_TIME(GridNodeTime);
+    TRACE_SPAN("GameBoard::updateGridNode");
+
     if (!m_gridDirty) {
         return;
     }
 
     QSGGeometryNode *gridNode = node->gridNode();
-    QSGGeometry *gridGeometry = gridNode->geometry();
+    const QSize gridSize(m_renderSnapshot->columns, m_renderSnapshot->rows);
+
+    if (!hasShaderMaterials()) {
+        // the node itself draws nothing, but every renderer can draw the
+        // rectangles of its children
+        if (gridNode->material() == nullptr) {
+            gridNode->setGeometry(new QSGGeometry(
+                QSGGeometry::defaultAttributes_Point2D(), 0));
+            gridNode->setFlag(QSGNode::OwnsGeometry);
+            gridNode->setMaterial(new QSGFlatColorMaterial());
+            gridNode->setFlag(QSGNode::OwnsMaterial);
+        }
 
-    if (gridGeometry == nullptr) {
-        gridGeometry = new QSGGeometry(
-            QSGGeometry::defaultAttributes_Point2D(), m_gridLines.size() * 2);
-        gridGeometry->setLineWidth(static_cast<float>(m_gridStroke->width()));
-        gridGeometry->setDrawingMode(QSGGeometry::DrawLines);
+        deleteChildNodes(gridNode);
+
+        const qreal strokeWidth = m_gridStroke->width();
+        const qreal width = gridSize.width() * m_gridSize + strokeWidth;
+        const qreal height = gridSize.height() * m_gridSize + strokeWidth;
+
+        for (int column = 0; column <= gridSize.width(); ++column) {
+            gridNode->appendChildNode(new QSGSimpleRectNode(
+                QRectF(
+                    column * m_gridSize - strokeWidth * 0.5,
+                    -strokeWidth * 0.5,
+                    strokeWidth,
+                    height),
+                m_gridStroke->color()));
+        }
+
+        for (int row = 0; row <= gridSize.height(); ++row) {
+            gridNode->appendChildNode(new QSGSimpleRectNode(
+                QRectF(
+                    -strokeWidth * 0.5,
+                    row * m_gridSize - strokeWidth * 0.5,
+                    width,
+                    strokeWidth),
+                m_gridStroke->color()));
+        }
+
+        return;
+    }
+
+    GridMaterial *gridMaterial =
+        static_cast<GridMaterial *>(gridNode->material());
+
+    if (gridMaterial == nullptr) {
+        QSGGeometry *gridGeometry = new QSGGeometry(
+            QSGGeometry::defaultAttributes_TexturedPoint2D(), 4);
+        gridGeometry->setDrawingMode(QSGGeometry::DrawTriangleStrip);
         gridNode->setGeometry(gridGeometry);
         gridNode->setFlag(QSGNode::OwnsGeometry);
 
-        QSGFlatColorMaterial *gridMaterial = new QSGFlatColorMaterial();
-        gridMaterial->setColor(m_gridStroke->color());
+        gridMaterial = new GridMaterial();
         gridNode->setMaterial(gridMaterial);
         gridNode->setFlag(QSGNode::OwnsMaterial);
-    } else {
-        gridGeometry->allocate(m_gridLines.size() * 2);
     }
 
-    QSGGeometry::Point2D *vertices = gridGeometry->vertexDataAsPoint2D();
-    size_t i = 0;
+    // the quad is measured in grid squares, so it only has to be rebuilt when
+    // the number of rows or columns changes
+    if (gridMaterial->gridSize() != gridSize) {
+        QSGGeometry::updateTexturedRectGeometry(
+            gridNode->geometry(),
+            QRectF(QPointF(0, 0), gridSize),
+            QRectF(-1, -1, 2, 2));
 
-    for (const QLineF &line : m_gridLines) {
-        vertices[i++].set(
-            static_cast<float>(line.x1()), static_cast<float>(line.y1()));
-        vertices[i++].set(
-            static_cast<float>(line.x2()), static_cast<float>(line.y2()));
+        gridNode->markDirty(QSGNode::DirtyGeometry);
     }
 
-    gridNode->markDirty(QSGNode::DirtyGeometry);
+    gridMaterial->setColor(m_gridStroke->color());
+    gridMaterial->setCellSize(m_gridSize);
+    gridMaterial->setStrokeWidth(m_gridStroke->width());
+    gridMaterial->setGridSize(gridSize);
+
+    gridNode->markDirty(QSGNode::DirtyMaterial);
+}
+
+void GameBoard::updateOverviewNode(GameBoard::QSGGameBoardNode *node)
+{
+    INSTRUMENT_TIME(OverviewNodeTime);
+    TRACE_SPAN("GameBoard::updateOverviewNode");
+
+    if (!m_dotsDirty && !m_gridDirty) {
+        return;
+    }
+
+    QSGGeometryNode *overviewNode = node->overviewNode();
+    QSGGeometry *overviewGeometry = overviewNode->geometry();
+
+    if (overviewGeometry == nullptr) {
+        overviewGeometry =
+            new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        overviewGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        overviewNode->setGeometry(overviewGeometry);
+        overviewNode->setFlag(QSGNode::OwnsGeometry);
+        overviewNode->setMaterial(new QSGVertexColorMaterial());
+        overviewNode->setFlag(QSGNode::OwnsMaterial);
+    }
+
+    if (!isOverview()) {
+        if (overviewGeometry->vertexCount() > 0) {
+            overviewGeometry->allocate(0);
+            overviewNode->markDirty(QSGNode::DirtyGeometry);
+        }
+
+        return;
+    }
+
+    const RenderSnapshot &snapshot = *m_renderSnapshot;
+    const int tileCount = findTileIndex(snapshot.columns, snapshot.rows) + 1;
+    std::vector<int> dotCounts(tileCount * m_numPlayers);
+
+    for (const Dot &dot : snapshot.dots) {
+        ++dotCounts[findTileIndex(dot.x(), dot.y()) * m_numPlayers
+                    + dot.player()];
+    }
+
+    const QRectF boardRect(
+        findIntersection(0, 0),
+        findIntersection(snapshot.columns, snapshot.rows));
+    std::vector<QSGGeometry::ColoredPoint2D> vertices;
+
+    // shade each tile in the colour of the player with the most dots in it,
+    // more strongly the more crowded it is
+    for (int tile = 0; tile < tileCount; ++tile) {
+        const std::vector<int>::const_iterator first =
+            dotCounts.begin() + tile * m_numPlayers;
+        const std::vector<int>::const_iterator owner =
+            std::max_element(first, first + m_numPlayers);
+
+        if (*owner == 0) {
+            continue;
+        }
+
+        const qreal density =
+            qMin<qreal>(1, *owner / (TILE_SIZE * TILE_SIZE * 0.25));
+        QColor color = m_markStrokes[static_cast<int>(owner - first)]->color();
+        color.setAlphaF(color.alphaF() * (0.25 + 0.5 * density));
+
+        const uchar r = static_cast<uchar>(color.red() * color.alphaF());
+        const uchar g = static_cast<uchar>(color.green() * color.alphaF());
+        const uchar b = static_cast<uchar>(color.blue() * color.alphaF());
+        const uchar a = static_cast<uchar>(color.alpha());
+        const QRectF rect = findTileRect(tile)
+                                .adjusted(
+                                    m_gridSize * 0.5,
+                                    m_gridSize * 0.5,
+                                    -m_gridSize * 0.5,
+                                    -m_gridSize * 0.5)
+                                .intersected(boardRect);
+        const float left = static_cast<float>(rect.left());
+        const float top = static_cast<float>(rect.top());
+        const float right = static_cast<float>(rect.right());
+        const float bottom = static_cast<float>(rect.bottom());
+        const float xs[] = {left, right, left, left, right, right};
+        const float ys[] = {top, top, bottom, bottom, top, bottom};
+
+        for (int i = 0; i < 6; ++i) {
+            QSGGeometry::ColoredPoint2D vertex;
+            vertex.set(xs[i], ys[i], r, g, b, a);
+            vertices.push_back(vertex);
+        }
+    }
+
+    overviewGeometry->allocate(static_cast<int>(vertices.size()));
+
+    if (!vertices.empty()) {
+        std::memcpy(
+            overviewGeometry->vertexData(),
+            vertices.data(),
+            vertices.size() * sizeof(QSGGeometry::ColoredPoint2D));
+    }
+
+    overviewNode->markDirty(QSGNode::DirtyGeometry);
+}
+
+void GameBoard::updateLegalMoveNode(GameBoard::QSGGameBoardNode *node)
+{
+    INSTRUMENT_TIME(LegalMoveNodeTime);
+    TRACE_SPAN("GameBoard::updateLegalMoveNode");
+
+    const RenderSnapshot &snapshot = *m_renderSnapshot;
+
+    // the overlay only changes with the game, the pending moves or the grid,
+    // so most frames leave it as it is
+    if (!m_legalMovesDirty && !m_gridDirty && !m_provisionalDirty
+        && snapshot.version == m_legalMovesVersion) {
+        return;
+    }
+
+    m_legalMovesVersion = snapshot.version;
+
+    QSGGeometryNode *legalMoveNode = node->legalMoveNode();
+    QSGGeometry *legalMoveGeometry = legalMoveNode->geometry();
+
+    if (legalMoveGeometry == nullptr) {
+        legalMoveGeometry =
+            new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        legalMoveGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        legalMoveNode->setGeometry(legalMoveGeometry);
+        legalMoveNode->setFlag(QSGNode::OwnsGeometry);
+        legalMoveNode->setMaterial(new QSGVertexColorMaterial());
+        legalMoveNode->setFlag(QSGNode::OwnsMaterial);
+    }
+
+    std::vector<QRectF> rects;
+
+    if (m_legalMovesVisible && !isOverview()
+        && snapshot.currentPlayer < m_markStrokes.size()) {
+        if (snapshot.placingDot) {
+            const int pointCount = snapshot.placeablePoints.size();
+            const qreal markSize = m_gridSize * 0.2;
+
+            for (int i = 0; i < pointCount; ++i) {
+                if (snapshot.placeablePoints.testBit(i)) {
+                    const QPointF intersection = findIntersection(
+                        i % (snapshot.columns + 1), i / (snapshot.columns + 1));
+
+                    rects.push_back(QRectF(
+                        intersection - QPointF(markSize * 0.5, markSize * 0.5),
+                        QSizeF(markSize, markSize)));
+                }
+            }
+        } else {
+            // a halo around each dot, which is drawn beneath it
+            for (const Dot &dot :
+                 m_renderProvisionalSnapshot->connectableDots) {
+                const QRectF dotRect = findDotRect(dot.x(), dot.y());
+                const qreal margin = dotRect.width() * 0.4;
+
+                rects.push_back(
+                    dotRect.adjusted(-margin, -margin, margin, margin));
+            }
+        }
+    }
+
+    legalMoveGeometry->allocate(static_cast<int>(rects.size()) * 6);
+    legalMoveNode->markDirty(QSGNode::DirtyGeometry);
+
+    if (rects.empty()) {
+        return;
+    }
+
+    QColor color = m_markStrokes[snapshot.currentPlayer]->color();
+    color.setAlphaF(color.alphaF() * 0.35);
+
+    const uchar r = static_cast<uchar>(color.red() * color.alphaF());
+    const uchar g = static_cast<uchar>(color.green() * color.alphaF());
+    const uchar b = static_cast<uchar>(color.blue() * color.alphaF());
+    const uchar a = static_cast<uchar>(color.alpha());
+    QSGGeometry::ColoredPoint2D *vertices =
+        legalMoveGeometry->vertexDataAsColoredPoint2D();
+
+    for (const QRectF &rect : rects) {
+        const float left = static_cast<float>(rect.left());
+        const float top = static_cast<float>(rect.top());
+        const float right = static_cast<float>(rect.right());
+        const float bottom = static_cast<float>(rect.bottom());
+        const float xs[] = {left, right, left, left, right, right};
+        const float ys[] = {top, top, bottom, bottom, top, bottom};
+
+        for (int i = 0; i < 6; ++i) {
+            (vertices++)->set(xs[i], ys[i], r, g, b, a);
+        }
+    }
+}
+
+void GameBoard::updateThreatNode(GameBoard::QSGGameBoardNode *node)
+{
+    INSTRUMENT_TIME(ThreatNodeTime);
+    TRACE_SPAN("GameBoard::updateThreatNode");
+
+    const RenderSnapshot &snapshot = *m_renderSnapshot;
+
+    if (!m_threatsDirty && !m_gridDirty
+        && snapshot.version == m_threatsVersion) {
+        return;
+    }
+
+    m_threatsVersion = snapshot.version;
+
+    QSGGeometryNode *threatNode = node->threatNode();
+    QSGGeometry *threatGeometry = threatNode->geometry();
+
+    if (threatGeometry == nullptr) {
+        threatGeometry =
+            new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        threatGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        threatNode->setGeometry(threatGeometry);
+        threatNode->setFlag(QSGNode::OwnsGeometry);
+        threatNode->setMaterial(new QSGVertexColorMaterial());
+        threatNode->setFlag(QSGNode::OwnsMaterial);
+    }
+
+    // a diamond around each threatened point, so that it stays distinct from
+    // the square marks of the legal moves
+    std::vector<std::pair<int, QPointF>> diamonds;
+
+    if (m_threatsVisible && !isOverview()) {
+        const int playerCount = qMin(
+            static_cast<int>(snapshot.threatenedPoints.size()),
+            m_markStrokes.size());
+
+        for (int player = 0; player < playerCount; ++player) {
+            const QBitArray &points = snapshot.threatenedPoints[player];
+            const int pointCount = points.size();
+
+            for (int i = 0; i < pointCount; ++i) {
+                if (points.testBit(i)) {
+                    diamonds.emplace_back(
+                        player,
+                        findIntersection(
+                            i % (snapshot.columns + 1),
+                            i / (snapshot.columns + 1)));
+                }
+            }
+        }
+    }
+
+    threatGeometry->allocate(static_cast<int>(diamonds.size()) * 6);
+    threatNode->markDirty(QSGNode::DirtyGeometry);
+
+    const float radius = static_cast<float>(m_gridSize * 0.3);
+    QSGGeometry::ColoredPoint2D *vertices =
+        threatGeometry->vertexDataAsColoredPoint2D();
+
+    for (const std::pair<int, QPointF> &diamond : diamonds) {
+        QColor color = m_markStrokes[diamond.first]->color();
+        color.setAlphaF(color.alphaF() * 0.3);
+
+        const uchar r = static_cast<uchar>(color.red() * color.alphaF());
+        const uchar g = static_cast<uchar>(color.green() * color.alphaF());
+        const uchar b = static_cast<uchar>(color.blue() * color.alphaF());
+        const uchar a = static_cast<uchar>(color.alpha());
+        const float x = static_cast<float>(diamond.second.x());
+        const float y = static_cast<float>(diamond.second.y());
+        const float xs[] = {
+            x, x + radius, x - radius, x - radius, x + radius, x};
+        const float ys[] = {y - radius, y, y, y, y, y + radius};
+
+        for (int i = 0; i < 6; ++i) {
+            (vertices++)->set(xs[i], ys[i], r, g, b, a);
+        }
+    }
 }
 
 void GameBoard::updateDotContainerNode(GameBoard::QSGGameBoardNode *node)
 {
+    INSTRUMENT_TIME(DotContainerTime);
+    TRACE_SPAN("GameBoard::updateDotContainerNode");
+
     if (!m_dotsDirty) {
         return;
     }
 
+    const RenderSnapshot &snapshot = *m_renderSnapshot;
     QSGNode *dotContainerNode = node->dotContainerNode();
+    QVector<QSGTileNode *> &dotTileNodes = node->dotTileNodes();
+
     if (m_gridDirty) {
-        dotContainerNode->removeAllChildNodes();
+        deleteChildNodes(dotContainerNode);
+        dotTileNodes.fill(
+            nullptr, findTileIndex(snapshot.columns, snapshot.rows) + 1);
     }
 
-    const std::vector<const Dot *> &dots = m_engine->getDots();
-    if (dots.empty()) {
+    // the dot images may still be rasterising
+    if (m_dotImages.size() < m_numPlayers) {
         return;
     }
 
+    QVector<DotMaterial *> dotMaterials = node->dotMaterials();
     QVector<QSGTexture *> dotTextures = node->dotTextures();
-    const QTransform gridDisplayTransform = GameBoard::gridDisplayTransform();
-    int i = 0;
+    std::vector<std::vector<const Dot *>> tileDots(
+        dotTileNodes.size() * m_numPlayers);
+    const qreal dotTexelSize = findDotTexelSize();
+    const bool shaderMaterials = hasShaderMaterials();
+
+    for (const Dot &dot : snapshot.dots) {
+        tileDots[findTileIndex(dot.x(), dot.y()) * m_numPlayers + dot.player()]
+            .push_back(&dot);
+    }
 
-    for (const Dot *pDot : dots) {
-        if (++i <= dotContainerNode->childCount()) {
-            continue;
+    for (int tile = 0; tile < dotTileNodes.size(); ++tile) {
+        QSGTileNode *tileNode = dotTileNodes[tile];
+
+        if (tileNode == nullptr) {
+            // most tiles of a large board stay empty for a long time
+            if (std::all_of(
+                    tileDots.begin() + tile * m_numPlayers,
+                    tileDots.begin() + (tile + 1) * m_numPlayers,
+                    [](const std::vector<const Dot *> &dots) {
+                        return dots.empty();
+                    })) {
+                continue;
+            }
+
+            tileNode = new QSGTileNode();
+            dotTileNodes[tile] = tileNode;
+            dotContainerNode->appendChildNode(tileNode);
         }
 
-        const Dot &dot = *pDot;
-        const QImage &dotImage = m_dotImages[dot.player()];
-        const QPointF intersection =
-            gridDisplayTransform.map(findIntersection(dot.x(), dot.y()));
-        const QRectF dotRect = QRectF(
-            (intersection
-             - QPointF(dotImage.width() * 0.5, dotImage.height() * 0.5)),
-            (intersection
-             + QPointF(dotImage.width() * 0.5, dotImage.height() * 0.5)));
+        for (int player = 0; player < m_numPlayers; ++player) {
+            // without the shader, each dot is a texture node of its own under
+            // a node of the player's
+            if (!shaderMaterials) {
+                QSGNode *playerNode = tileNode->childAtIndex(player);
+                const std::vector<const Dot *> &dots =
+                    tileDots[tile * m_numPlayers + player];
+
+                if (playerNode == nullptr) {
+                    playerNode = new QSGNode();
+                    tileNode->appendChildNode(playerNode);
+                } else if (m_dotImagesDirty) {
+                    for (QSGNode *dotNode = playerNode->firstChild();
+                         dotNode != nullptr;
+                         dotNode = dotNode->nextSibling()) {
+                        static_cast<QSGSimpleTextureNode *>(dotNode)
+                            ->setTexture(dotTextures[player]);
+                    }
+                }
+
+                for (int i = playerNode->childCount();
+                     i < static_cast<int>(dots.size());
+                     ++i) {
+                    playerNode->appendChildNode(
+                        makeDotTextureNode(*dots[i], dotTextures[player]));
+                }
+
+                continue;
+            }
+
+            QSGGeometryNode *dotsNode =
+                static_cast<QSGGeometryNode *>(tileNode->childAtIndex(player));
+
+            if (dotsNode == nullptr) {
+                dotsNode = new QSGGeometryNode();
+                QSGGeometry *dotsGeometry =
+                    new QSGGeometry(DotMaterial::attributes(), 0);
+                dotsGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+                dotsNode->setGeometry(dotsGeometry);
+                dotsNode->setFlag(QSGNode::OwnsGeometry);
+                dotsNode->setMaterial(dotMaterials[player]);
+                tileNode->appendChildNode(dotsNode);
+            } else if (m_dotImagesDirty) {
+                dotsNode->setMaterial(dotMaterials[player]);
+            }
+
+            QSGGeometry *dotsGeometry = dotsNode->geometry();
+
+            // dots are never removed during a game, so only the new dots have
+            // to be appended
+            const std::vector<const Dot *> &dots =
+                tileDots[tile * m_numPlayers + player];
+            const int first = dotsGeometry->vertexCount() / DOT_VERTEX_COUNT;
+            const int count = static_cast<int>(dots.size());
+
+            if (first >= count) {
+                continue;
+            }
+
+            resizeGeometry(dotsGeometry, count * DOT_VERTEX_COUNT);
+
+            DotMaterial::Vertex *vertices =
+                static_cast<DotMaterial::Vertex *>(dotsGeometry->vertexData())
+                + first * DOT_VERTEX_COUNT;
 
-        QSGImageNode *dotNode = window()->createImageNode();
-        dotNode->setRect(dotRect);
-        QSGTexture *dotTexture = dotTextures[dot.player()];
-        dotNode->setTexture(dotTexture);
-        dotContainerNode->appendChildNode(dotNode);
+            for (int i = first; i < count; ++i) {
+                const Dot &dot = *dots[i];
+
+                DotMaterial::appendQuad(
+                    vertices, findDotRect(dot.x(), dot.y()), dotTexelSize);
+            }
+
+            dotsNode->markDirty(QSGNode::DirtyGeometry);
+        }
     }
 }
 
 void GameBoard::updateLineContainerNode(GameBoard::QSGGameBoardNode *node)
 {
+    INSTRUMENT_TIME(LineContainerTime);
+    TRACE_SPAN("GameBoard::updateLineContainerNode");
+
     if (!m_linesDirty) {
         return;
     }
 
+    const RenderSnapshot &snapshot = *m_renderSnapshot;
     QSGNode *lineContainerNode = node->lineContainerNode();
+    QVector<QSGTileNode *> &lineTileNodes = node->lineTileNodes();
+
     if (m_gridDirty) {
-        lineContainerNode->removeAllChildNodes();
+        deleteChildNodes(lineContainerNode);
+        lineTileNodes.fill(
+            nullptr, findTileIndex(snapshot.columns, snapshot.rows) + 1);
     }
 
-    QVector<QSGMaterial *> lineMaterials = node->lineMaterials();
-    const QTransform gridDisplayTransform = GameBoard::gridDisplayTransform();
+    QVector<LineMaterial *> lineMaterials = node->lineMaterials();
+    std::vector<std::vector<const RenderSnapshot::Segment *>> tileLines(
+        lineTileNodes.size() * m_numPlayers);
+    const bool shaderMaterials = hasShaderMaterials();
 
+    // a line is kept with the tile of its first endpoint
     for (int player = 0; player < m_numPlayers; ++player) {
-        const std::vector<const Line *> &lines = m_engine->getLines(player);
-        QSGGeometryNode *linesNode = static_cast<QSGGeometryNode *>(
-            lineContainerNode->childAtIndex(player));
-        QSGGeometry *linesGeometry = nullptr;
-        const int vertexCount = static_cast<int>(lines.size() * 2);
-
-        if (linesNode == nullptr) {
-            const Stroke *stroke = m_markStrokes[player];
-            QSGMaterial *lineMaterial = lineMaterials[player];
-
-            linesNode = new QSGGeometryNode();
-            linesGeometry = new QSGGeometry(
-                QSGGeometry::defaultAttributes_Point2D(), vertexCount);
-            linesGeometry->setLineWidth(static_cast<float>(stroke->width()));
-            linesGeometry->setDrawingMode(QSGGeometry::DrawLines);
-            linesNode->setGeometry(linesGeometry);
-            linesNode->setFlag(QSGNode::OwnsGeometry);
-            linesNode->setMaterial(lineMaterial);
-            lineContainerNode->appendChildNode(linesNode);
-        } else {
-            linesGeometry = linesNode->geometry();
-            if (linesGeometry->vertexCount() == vertexCount) {
+        for (const RenderSnapshot::Segment &line : snapshot.lines[player]) {
+            const Dot &endpoint = line.endpoint1;
+
+            tileLines[findTileIndex(endpoint.x(), endpoint.y()) * m_numPlayers
+                      + player]
+                .push_back(&line);
+        }
+    }
+
+    for (int tile = 0; tile < lineTileNodes.size(); ++tile) {
+        QSGTileNode *tileNode = lineTileNodes[tile];
+
+        if (tileNode == nullptr) {
+            if (std::all_of(
+                    tileLines.begin() + tile * m_numPlayers,
+                    tileLines.begin() + (tile + 1) * m_numPlayers,
+                    [](const std::vector<const RenderSnapshot::Segment *>
+                           &lines) {
+                        return lines.empty();
+                    })) {
                 continue;
             }
-            linesGeometry->allocate(vertexCount);
+
+            tileNode = new QSGTileNode();
+            lineTileNodes[tile] = tileNode;
+            lineContainerNode->appendChildNode(tileNode);
         }
 
-        QSGGeometry::Point2D *vertices = linesGeometry->vertexDataAsPoint2D();
-        size_t i = 0;
+        for (int player = 0; player < m_numPlayers; ++player) {
+            // without the shader, each line is a node of its own under a node
+            // of the player's
+            if (!shaderMaterials) {
+                QSGNode *playerNode = tileNode->childAtIndex(player);
+                const std::vector<const RenderSnapshot::Segment *> &lines =
+                    tileLines[tile * m_numPlayers + player];
+                const qreal width = m_markStrokes[player]->width();
+
+                if (playerNode == nullptr) {
+                    playerNode = new QSGNode();
+                    tileNode->appendChildNode(playerNode);
+                }
 
-        for (const Line *pLine : lines) {
-            const Line &line = *pLine;
+                for (int i = playerNode->childCount();
+                     i < static_cast<int>(lines.size());
+                     ++i) {
+                    const Dot &endpoint1 = lines[i]->endpoint1;
+                    const Dot &endpoint2 = lines[i]->endpoint2;
+
+                    playerNode->appendChildNode(makeSegmentNode(
+                        findIntersection(endpoint1.x(), endpoint1.y()),
+                        findIntersection(endpoint2.x(), endpoint2.y()),
+                        width,
+                        lineMaterials[player]->color()));
+                }
 
-            for (const Dot &dot : {line.endpoint1(), line.endpoint2()}) {
-                QPointF point = gridDisplayTransform.map(
-                    findIntersection(dot.x(), dot.y()));
-                vertices[i++].set(
-                    static_cast<float>(point.x()),
-                    static_cast<float>(point.y()));
+                continue;
+            }
+
+            QSGGeometryNode *linesNode =
+                static_cast<QSGGeometryNode *>(tileNode->childAtIndex(player));
+
+            if (linesNode == nullptr) {
+                linesNode = new QSGGeometryNode();
+                QSGGeometry *linesGeometry =
+                    new QSGGeometry(LineMaterial::attributes(), 0, 0);
+                linesGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+                linesNode->setGeometry(linesGeometry);
+                linesNode->setFlag(QSGNode::OwnsGeometry);
+                linesNode->setMaterial(lineMaterials[player]);
+                tileNode->appendChildNode(linesNode);
+            }
+
+            QSGGeometry *linesGeometry = linesNode->geometry();
+
+            // lines are never removed during a game either, and the few
+            // segments of a tile always fit 16-bit indices
+            const std::vector<const RenderSnapshot::Segment *> &lines =
+                tileLines[tile * m_numPlayers + player];
+            const int first = linesGeometry->vertexCount()
+                / LineMaterial::SEGMENT_VERTEX_COUNT;
+            const int count = static_cast<int>(lines.size());
+
+            if (first >= count) {
+                continue;
+            }
+
+            resizeGeometry(
+                linesGeometry,
+                count * LineMaterial::SEGMENT_VERTEX_COUNT,
+                count * LineMaterial::SEGMENT_INDEX_COUNT);
+
+            LineMaterial::Vertex *vertices =
+                static_cast<LineMaterial::Vertex *>(
+                    linesGeometry->vertexData())
+                + first * LineMaterial::SEGMENT_VERTEX_COUNT;
+            quint16 *indices = linesGeometry->indexDataAsUShort()
+                + first * LineMaterial::SEGMENT_INDEX_COUNT;
+            const qreal width = m_markStrokes[player]->width();
+
+            for (int i = first; i < count; ++i) {
+                const Dot &endpoint1 = lines[i]->endpoint1;
+                const Dot &endpoint2 = lines[i]->endpoint2;
+
+                LineMaterial::appendSegmentIndices(
+                    indices, i * LineMaterial::SEGMENT_VERTEX_COUNT);
+                LineMaterial::appendSegment(
+                    vertices,
+                    findIntersection(endpoint1.x(), endpoint1.y()),
+                    findIntersection(endpoint2.x(), endpoint2.y()),
+                    width);
             }
-        }
 
-        linesNode->markDirty(QSGNode::DirtyGeometry);
+            linesNode->markDirty(QSGNode::DirtyGeometry);
+        }
     }
 }
 
 void GameBoard::updateChainContainerNode(GameBoard::QSGGameBoardNode *node)
 {
+    INSTRUMENT_TIME(ChainContainerTime);
+    TRACE_SPAN("GameBoard::updateChainContainerNode");
+
+    if (!m_chainsDirty) {
+        return;
+    }
+
     QSGNode *chainContainerNode = node->chainContainerNode();
-    chainContainerNode->removeAllChildNodes();
-
-    const std::vector<std::vector<const Dot *>> &chains = m_engine->getChains();
-    Stroke *stroke = m_markStrokes[m_engine->currentPlayer()];
-    QVector<QSGMaterial *> lineMaterials = node->lineMaterials();
-    QSGMaterial *chainMaterial = lineMaterials[m_engine->currentPlayer()];
-    const QTransform gridDisplayTransform = GameBoard::gridDisplayTransform();
-
-    for (const std::vector<const Dot *> &chain : chains) {
-        QSGGeometryNode *chainNode = new QSGGeometryNode();
-        QSGGeometry *chainGeometry = new QSGGeometry(
-            QSGGeometry::defaultAttributes_Point2D(),
-            static_cast<int>(chain.size()));
-        chainGeometry->setLineWidth(static_cast<float>(stroke->width()));
-        chainGeometry->setDrawingMode(QSGGeometry::DrawLineStrip);
-        chainNode->setGeometry(chainGeometry);
-        chainNode->setFlag(QSGNode::OwnsGeometry);
-        // painter->setPen(QPen(stroke->color(), stroke->width(), Qt::DashLine,
-        // Qt::FlatCap));
-        chainNode->setMaterial(chainMaterial);
-        chainContainerNode->appendChildNode(chainNode);
-
-        QSGGeometry::Point2D *vertices = chainGeometry->vertexDataAsPoint2D();
-        size_t i = 0;
-
-        for (const Dot *pDot : chain) {
-            const Dot dot = *pDot;
-            const QPointF point =
-                gridDisplayTransform.map(findIntersection(dot.x(), dot.y()));
-
-            vertices[i++].set(
-                static_cast<float>(point.x()), static_cast<float>(point.y()));
+    deleteChildNodes(chainContainerNode);
+
+    const RenderSnapshot &snapshot = *m_renderSnapshot;
+    QVector<LineMaterial *> lineMaterials = node->lineMaterials();
+    LineMaterial *chainMaterial = lineMaterials[snapshot.currentPlayer];
+    const qreal chainWidth = m_markStrokes[snapshot.currentPlayer]->width();
+
+    for (const std::vector<Dot> &chain : snapshot.chains) {
+        std::vector<QPointF> points;
+
+        for (const Dot &dot : chain) {
+            points.push_back(findIntersection(dot.x(), dot.y()));
         }
+
+        chainContainerNode->appendChildNode(
+            makeChainNode(points, chainMaterial, chainWidth));
     }
 }
 
 void GameBoard::updateProvisionalDotContainerNode(
     GameBoard::QSGGameBoardNode *node)
 {
+    INSTRUMENT_TIME(ProvisionalDotContainerTime);
+    TRACE_SPAN("GameBoard::updateProvisionalDotContainerNode");
+
+    // new dot images release the materials and textures of the old ones,
+    // which the node must not keep even while it draws nothing
+    if (!m_provisionalDirty && !m_dotImagesDirty) {
+        return;
+    }
+
+    // the dot images may still be rasterising
+    if (m_dotImages.size() < m_numPlayers) {
+        return;
+    }
+
+    const int currentPlayer = m_renderSnapshot->currentPlayer;
+    const Dot &provisionalDot = m_renderProvisionalSnapshot->dot;
     QSGOpacityNode *provisionalDotContainerNode =
         node->provisionalDotContainerNode();
     provisionalDotContainerNode->setOpacity(0.5);
-    provisionalDotContainerNode->removeAllChildNodes();
 
-    if (!m_provisionalDot.isValid()) {
+    if (!hasShaderMaterials()) {
+        deleteChildNodes(provisionalDotContainerNode);
+
+        if (provisionalDot.isValid()) {
+            provisionalDotContainerNode->appendChildNode(makeDotTextureNode(
+                provisionalDot, node->dotTextures()[currentPlayer]));
+        }
+
         return;
     }
 
-    const QImage &dotImage = m_dotImages[m_engine->currentPlayer()];
-    QVector<QSGTexture *> dotTextures = node->dotTextures();
-    const QTransform gridDisplayTransform = GameBoard::gridDisplayTransform();
-    const QPointF intersection = gridDisplayTransform.map(
-        findIntersection(m_provisionalDot.x(), m_provisionalDot.y()));
-    const QRectF dotRect = QRectF(
-        (intersection
-         - QPointF(dotImage.width() * 0.5, dotImage.height() * 0.5)),
-        (intersection
-         + QPointF(dotImage.width() * 0.5, dotImage.height() * 0.5)));
-
-    QSGImageNode *dotNode = window()->createImageNode();
-    dotNode->setRect(dotRect);
-    QSGTexture *dotTexture = dotTextures[m_engine->currentPlayer()];
-    dotNode->setTexture(dotTexture);
-    provisionalDotContainerNode->appendChildNode(dotNode);
+    QSGGeometryNode *dotNode = static_cast<QSGGeometryNode *>(
+        provisionalDotContainerNode->firstChild());
+    QVector<DotMaterial *> dotMaterials = node->dotMaterials();
+
+    if (dotNode == nullptr) {
+        dotNode = new QSGGeometryNode();
+        QSGGeometry *dotGeometry =
+            new QSGGeometry(DotMaterial::attributes(), 0);
+        dotGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        dotNode->setGeometry(dotGeometry);
+        dotNode->setFlag(QSGNode::OwnsGeometry);
+        dotNode->setMaterial(dotMaterials[currentPlayer]);
+        provisionalDotContainerNode->appendChildNode(dotNode);
+    }
+
+    QSGGeometry *dotGeometry = dotNode->geometry();
+
+    dotNode->setMaterial(dotMaterials[currentPlayer]);
+
+    if (!provisionalDot.isValid()) {
+        dotGeometry->allocate(0);
+        dotNode->markDirty(QSGNode::DirtyGeometry | QSGNode::DirtyMaterial);
+
+        return;
+    }
+
+    dotGeometry->allocate(DOT_VERTEX_COUNT);
+
+    DotMaterial::Vertex *vertices =
+        static_cast<DotMaterial::Vertex *>(dotGeometry->vertexData());
+    DotMaterial::appendQuad(
+        vertices,
+        findDotRect(provisionalDot.x(), provisionalDot.y()),
+        findDotTexelSize());
+
+    dotNode->markDirty(QSGNode::DirtyGeometry | QSGNode::DirtyMaterial);
 }
 
 void GameBoard::updateProvisionalChainContainerNode(
     GameBoard::QSGGameBoardNode *node)
 {
+    INSTRUMENT_TIME(ProvisionalChainContainerTime);
+    TRACE_SPAN("GameBoard::updateProvisionalChainContainerNode");
+
+    if (!m_provisionalDirty) {
+        return;
+    }
+
     QSGOpacityNode *provisionalChainContainerNode =
         node->provisionalChainContainerNode();
     provisionalChainContainerNode->setOpacity(0.5);
-    provisionalChainContainerNode->removeAllChildNodes();
+    deleteChildNodes(provisionalChainContainerNode);
 
-    if (m_provisionalChain.size() <= 1) {
+    const std::vector<Dot> &chain = m_renderProvisionalSnapshot->chain;
+
+    if (chain.size() <= 1) {
         return;
     }
 
-    const std::deque<Dot> &chain = m_provisionalChain;
-    Stroke *stroke = m_markStrokes[m_engine->currentPlayer()];
-    QVector<QSGMaterial *> lineMaterials = node->lineMaterials();
-    QSGMaterial *chainMaterial = lineMaterials[m_engine->currentPlayer()];
-    const QTransform gridDisplayTransform = GameBoard::gridDisplayTransform();
+    QVector<LineMaterial *> lineMaterials = node->lineMaterials();
+    LineMaterial *chainMaterial =
+        lineMaterials[m_renderSnapshot->currentPlayer];
+    const qreal chainWidth =
+        m_markStrokes[m_renderSnapshot->currentPlayer]->width();
+    std::vector<QPointF> points;
 
-    QSGGeometryNode *chainNode = new QSGGeometryNode();
-    QSGGeometry *chainGeometry = new QSGGeometry(
-        QSGGeometry::defaultAttributes_Point2D(),
-        static_cast<int>(chain.size()));
-    chainGeometry->setLineWidth(static_cast<float>(stroke->width()));
-    chainGeometry->setDrawingMode(QSGGeometry::DrawLineStrip);
-    chainNode->setGeometry(chainGeometry);
-    chainNode->setFlag(QSGNode::OwnsGeometry);
-    // painter->setPen(QPen(stroke->color(), stroke->width(), Qt::DashLine,
-    // Qt::FlatCap));
-    chainNode->setMaterial(chainMaterial);
-    provisionalChainContainerNode->appendChildNode(chainNode);
+    for (const Dot &dot : chain) {
+        points.push_back(findIntersection(dot.x(), dot.y()));
+    }
 
-    QSGGeometry::Point2D *vertices = chainGeometry->vertexDataAsPoint2D();
-    size_t i = 0;
+    provisionalChainContainerNode->appendChildNode(
+        makeChainNode(points, chainMaterial, chainWidth));
+}
 
-    for (const Dot &dot : chain) {
-        const QPointF point =
-            gridDisplayTransform.map(findIntersection(dot.x(), dot.y()));
+void GameBoard::updateTileNodes(GameBoard::QSGGameBoardNode *node)
+{
+    TRACE_SPAN("GameBoard::updateTileNodes");
+
+    // new tiles have to be culled as well
+    if (!m_viewportDirty && !m_dotsDirty && !m_linesDirty) {
+        return;
+    }
 
-        vertices[i++].set(
-            static_cast<float>(point.x()), static_cast<float>(point.y()));
+    const QRectF visibleRect = findVisibleRect();
+    const bool overview = isOverview();
+
+    for (QVector<QSGTileNode *> *tileNodes :
+         {&node->dotTileNodes(), &node->lineTileNodes()}) {
+        for (int tile = 0; tile < tileNodes->size(); ++tile) {
+            QSGTileNode *tileNode = tileNodes->at(tile);
+
+            if (tileNode != nullptr) {
+                tileNode->setCulled(
+                    overview
+                    || !findTileRect(tile).intersects(visibleRect));
+            }
+        }
     }
 }
 
-void GameBoard::prepareDotTextures(GameBoard::QSGGameBoardNode *node)
+void GameBoard::prepareDotMaterials(GameBoard::QSGGameBoardNode *node)
 {
     if (!m_dotImagesDirty) {
         return;
     }
 
-    QVector<QSGTexture *> dotTextures = node->dotTextures();
+    QVector<DotMaterial *> dotMaterials;
 
-    for (const QSGTexture *dotTexture : dotTextures) {
-        delete dotTexture;
+    // the textures and materials are owned by the caches and shared with the
+    // other boards in the window
+    if (!hasShaderMaterials()) {
+        QVector<QSGTexture *> dotTextures;
+
+        for (const QImage &dotImage : m_dotImages) {
+            dotTextures.append(DotImageCache::texture(
+                window(), DotImageCache::markerImage(dotImage)));
+        }
+
+        node->setDotTextures(dotTextures);
+
+        return;
     }
-    dotTextures.clear();
 
     for (const QImage &dotImage : m_dotImages) {
-        QSGTexture *dotTexture = window()->createTextureFromImage(dotImage);
-        dotTextures.append(dotTexture);
+        QSGTexture *dotTexture = DotImageCache::texture(window(), dotImage);
+
+        dotMaterials.append(MaterialCache::dotMaterial(window(), dotTexture));
     }
 
-    node->setDotTextures(dotTextures);
+    node->setDotMaterials(dotMaterials);
 }
 
 void GameBoard::prepareLineMaterials(GameBoard::QSGGameBoardNode *node)
 {
-    if (!m_lineMaterialsDirty) {
+    if (!m_lineMaterialsDirty && !m_gridDirty) {
         return;
     }
 
-    QVector<QSGMaterial *> lineMaterials = node->lineMaterials();
-
-    for (const QSGMaterial *lineMaterial : lineMaterials) {
-        delete lineMaterial;
-    }
-    lineMaterials.clear();
+    QVector<LineMaterial *> lineMaterials;
 
+    // the widths of the strokes go into the vertices, so the materials only
+    // depend on the colours and are shared with the other boards in the window
     for (const Stroke *stroke : m_markStrokes) {
-        QSGFlatColorMaterial *lineMaterial = new QSGFlatColorMaterial();
-        lineMaterial->setColor(stroke->color());
-        lineMaterials.append(lineMaterial);
+        lineMaterials.append(
+            MaterialCache::lineMaterial(window(), stroke->color()));
     }
 
     node->setLineMaterials(lineMaterials);
 }
 
+void GameBoard::resizeGeometry(
+    QSGGeometry *geometry,
+    int vertexCount,
+    int indexCount)
+{
+    // QSGGeometry::allocate() discards the data, so keep what still fits
+    const QByteArray vertexData(
+        static_cast<const char *>(geometry->vertexData()),
+        qMin(geometry->vertexCount(), vertexCount) * geometry->sizeOfVertex());
+    const QByteArray indexData(
+        static_cast<const char *>(geometry->indexData()),
+        qMin(geometry->indexCount(), indexCount) * geometry->sizeOfIndex());
+
+    geometry->allocate(vertexCount, indexCount);
+
+    if (!vertexData.isEmpty()) {
+        std::memcpy(
+            geometry->vertexData(), vertexData.constData(), vertexData.size());
+    }
+
+    if (!indexData.isEmpty()) {
+        std::memcpy(
+            geometry->indexData(), indexData.constData(), indexData.size());
+    }
+}
+
+void GameBoard::deleteChildNodes(QSGNode *node)
+{
+    // QSGNode::removeAllChildNodes() leaves the children to the caller
+    while (QSGNode *child = node->firstChild()) {
+        node->removeChildNode(child);
+        delete child;
+    }
+}
+
 QTransform GameBoard::gridDisplayTransform() const
 {
-    return QTransform().rotate(m_gridRotation);
+    // the grid's rows and columns are those of the board after rotation,
+    // and are only laid out on the GUI thread
+    const bool rotated = !qFuzzyIsNull(m_gridRotation);
+    const QRectF boardRect(
+        0,
+        0,
+        (rotated ? m_gridRows : m_gridColumns) * m_gridSize,
+        (rotated ? m_gridColumns : m_gridRows) * m_gridSize);
+    const QTransform rotation = QTransform().rotate(m_gridRotation);
+    const QPointF offset =
+        m_gridRect.topLeft() - rotation.mapRect(boardRect).topLeft();
+
+    return rotation * QTransform::fromTranslate(offset.x(), offset.y());
 }
@@ -2,6 +2,7 @@
 #define GAMEBOARD_H
 
 #include "dot.h"
+#include <QFutureWatcher>
 #include <QImage>
 #include <QList>
 #include <QQuickItem>
@@ -9,14 +10,20 @@
 #include <QSGMaterial>
 #include <QSGNode>
 #include <QSGOpacityNode>
-#include <QSGTexture>
-#include <QSvgRenderer>
-#include <QVarLengthArray>
+#include <QSGTransformNode>
 #include <QVector>
 #include <deque>
+#include <memory>
+#include <vector>
 
-class Stroke;
+class DotMaterial;
 class GameEngine;
+class LineMaterial;
+class QColor;
+class QSGSimpleTextureNode;
+class QSGTexture;
+class Stroke;
+struct RenderSnapshot;
 
 class GameBoard : public QQuickItem
 {
@@ -27,6 +34,12 @@ class GameBoard : public QQuickItem
     Q_PROPERTY(Stroke *gridStroke READ gridStroke)
     Q_PROPERTY(
         bool hasPendingMoves READ hasPendingMoves NOTIFY hasPendingMovesChanged)
+    Q_PROPERTY(
+        QRectF viewport READ viewport WRITE setViewport NOTIFY viewportChanged)
+    Q_PROPERTY(bool legalMovesVisible READ legalMovesVisible WRITE
+                   setLegalMovesVisible NOTIFY legalMovesVisibleChanged)
+    Q_PROPERTY(bool threatsVisible READ threatsVisible WRITE setThreatsVisible
+                   NOTIFY threatsVisibleChanged)
 
 public:
     explicit GameBoard(QQuickItem *parent = nullptr);
@@ -48,12 +61,34 @@ public:
 
     bool hasPendingMoves() const;
 
+    /// \returns The visible part of the board in item coordinates, or a null
+    /// rect if the whole board is visible.
+    QRectF viewport() const;
+    void setViewport(const QRectF &viewport);
+
+    /// Checks if the legal moves are highlighted: the points where a dot can
+    /// be placed, or the dots which can be connected to the ends of the
+    /// pending chain.
+    bool legalMovesVisible() const;
+    void setLegalMovesVisible(bool visible);
+
+    /// Checks if the points each player could capture with their next move
+    /// are highlighted, in the colour of that player.
+    bool threatsVisible() const;
+    void setThreatsVisible(bool visible);
+
 public slots:
     void markPosition(QPoint pos);
+
+    /// Marks the intersection at (x,y) on the grid, as if it was touched.
+    void markIntersection(int x, int y);
     void acceptMove(bool accepted = true);
 
 signals:
     void hasPendingMovesChanged();
+    void viewportChanged();
+    void legalMovesVisibleChanged();
+    void threatsVisibleChanged();
 
 protected slots:
     void setUpBoard();
@@ -66,34 +101,83 @@ protected:
     QSGNode *updatePaintNode(QSGNode *, UpdatePaintNodeData *) override;
 
 private:
-    class QSGGameBoardNode : public QSGNode
+    /// Holds the marks around a square of TILE_SIZE × TILE_SIZE intersections,
+    /// so that they can be left out of rendering while off screen.
+    class QSGTileNode : public QSGNode
+    {
+    public:
+        explicit QSGTileNode();
+
+        bool isCulled() const;
+        void setCulled(bool culled);
+
+        bool isSubtreeBlocked() const override;
+
+    private:
+        bool m_culled;
+    };
+
+    class QSGGameBoardNode : public QSGTransformNode
     {
     public:
-        explicit QSGGameBoardNode();
-        ~QSGGameBoardNode();
+        explicit QSGGameBoardNode(QQuickWindow *window);
+        ~QSGGameBoardNode() override;
 
         QSGGeometryNode *gridNode() const;
+        QSGGeometryNode *overviewNode() const;
+        QSGGeometryNode *legalMoveNode() const;
+        QSGGeometryNode *threatNode() const;
         QSGNode *dotContainerNode() const;
         QSGNode *lineContainerNode() const;
         QSGNode *chainContainerNode() const;
         QSGOpacityNode *provisionalDotContainerNode() const;
         QSGOpacityNode *provisionalChainContainerNode() const;
 
+        /// Gets the dot materials, each with a reference held on it and on
+        /// its texture, which are given back once the materials are replaced
+        /// or the node is deleted.
+        QVector<DotMaterial *> dotMaterials() const;
+        void setDotMaterials(QVector<DotMaterial *> dotMaterials);
+
+        /// Gets the textures of the plain markers, which are drawn instead of
+        /// the dot materials when the shaders cannot run. A reference is held
+        /// on each like on the dot materials.
         QVector<QSGTexture *> dotTextures() const;
         void setDotTextures(QVector<QSGTexture *> dotTextures);
 
-        QVector<QSGMaterial *> lineMaterials() const;
-        void setLineMaterials(QVector<QSGMaterial *> lineMaterials);
+        QVector<LineMaterial *> lineMaterials() const;
+        void setLineMaterials(QVector<LineMaterial *> lineMaterials);
+
+        QVector<QSGTileNode *> &dotTileNodes();
+        QVector<QSGTileNode *> &lineTileNodes();
 
     private:
+        QQuickWindow *m_window;
         QSGGeometryNode *m_gridNode;
+        QSGGeometryNode *m_overviewNode;
+        QSGGeometryNode *m_legalMoveNode;
+        QSGGeometryNode *m_threatNode;
         QSGNode *m_dotContainerNode;
         QSGNode *m_lineContainerNode;
         QSGNode *m_chainContainerNode;
         QSGOpacityNode *m_provisionalDotContainerNode;
         QSGOpacityNode *m_provisionalChainContainerNode;
+        QVector<DotMaterial *> m_dotMaterials;
         QVector<QSGTexture *> m_dotTextures;
-        QVector<QSGMaterial *> m_lineMaterials;
+        QVector<LineMaterial *> m_lineMaterials;
+        QVector<QSGTileNode *> m_dotTileNodes;
+        QVector<QSGTileNode *> m_lineTileNodes;
+    };
+
+    /// Copy of the pending moves for the render thread.
+    struct ProvisionalSnapshot
+    {
+        Dot dot;
+        std::vector<Dot> chain;
+
+        /// The dots which can be connected to either end of the chain, if
+        /// the legal moves are visible.
+        std::vector<Dot> connectableDots;
     };
 
     static void appendMarkStroke(
@@ -103,26 +187,65 @@ private:
     static Stroke *markStroke(QQmlListProperty<Stroke> *property, int index);
     static void clearMarkStrokes(QQmlListProperty<Stroke> *property);
 
-    void makeGrid();
+    void layOutGrid();
     void makeDotImages();
+    void setDotImages(const QVector<QImage> &dotImages);
     void tryAddToChain(const Dot &dot);
+    void publishProvisionalSnapshot();
     QPointF findIntersection(int x, int y) const;
+    qreal findDotTexelSize() const;
+    QSGNode *makeChainNode(
+        const std::vector<QPointF> &points,
+        LineMaterial *material,
+        qreal width) const;
+    QSGTransformNode *makeSegmentNode(
+        const QPointF &point1,
+        const QPointF &point2,
+        qreal width,
+        const QColor &color) const;
+    QRectF findDotRect(int x, int y) const;
+    QSGSimpleTextureNode *makeDotTextureNode(
+        const Dot &dot,
+        QSGTexture *texture) const;
+    int findTileColumnCount() const;
+    int findTileIndex(int x, int y) const;
+    QRectF findTileRect(int index) const;
+    QRectF findVisibleRect() const;
+    bool isOverview() const;
+
+    /// Checks if the scene graph can draw the custom materials. Otherwise the
+    /// board is drawn with the nodes that every renderer supports.
+    bool hasShaderMaterials() const;
 
     bool isReady() const;
 
     void updateGridNode(QSGGameBoardNode *node);
+    void updateOverviewNode(QSGGameBoardNode *node);
+    void updateLegalMoveNode(QSGGameBoardNode *node);
+    void updateThreatNode(QSGGameBoardNode *node);
     void updateDotContainerNode(QSGGameBoardNode *node);
     void updateLineContainerNode(QSGGameBoardNode *node);
     void updateChainContainerNode(QSGGameBoardNode *node);
     void updateProvisionalDotContainerNode(QSGGameBoardNode *node);
     void updateProvisionalChainContainerNode(QSGGameBoardNode *node);
+    void updateTileNodes(QSGGameBoardNode *node);
 
-    void prepareDotTextures(QSGGameBoardNode *node);
+    void prepareDotMaterials(QSGGameBoardNode *node);
     void prepareLineMaterials(QSGGameBoardNode *node);
 
     QTransform gridDisplayTransform() const;
 
+    static void resizeGeometry(
+        QSGGeometry *geometry,
+        int vertexCount,
+        int indexCount = 0);
+    static void deleteChildNodes(QSGNode *node);
+
     static const int DEFAULT_NUM_PLAYERS = 2;
+    static const int DOT_VERTEX_COUNT = 6;
+    static const int TILE_SIZE = 16;
+    // below this many pixels per grid square, tiles are drawn as plain quads
+    static const int OVERVIEW_GRID_SIZE = 4;
 
     GameEngine *m_engine;
     int m_numPlayers;
@@ -134,16 +257,34 @@ private:
     qreal m_gridRotation;
     qreal m_gridSize;
     QRectF m_gridRect;
-    QVarLengthArray<QLineF, 100> m_gridLines;
-    QVarLengthArray<QSvgRenderer *, DEFAULT_NUM_PLAYERS> m_dotSvgRenderers;
-    QVarLengthArray<QImage, DEFAULT_NUM_PLAYERS> m_dotImages;
+    QRectF m_viewport;
+    bool m_legalMovesVisible;
+    bool m_threatsVisible;
+    QVector<QImage> m_dotImages;
+    QFutureWatcher<QVector<QImage>> m_dotImagesWatcher;
+    int m_dotImagesGeneration;
+    int m_pendingDotImagesGeneration;
     Dot m_provisionalDot;
     std::deque<Dot> m_provisionalChain;
+    std::shared_ptr<const ProvisionalSnapshot> m_provisionalSnapshot;
+
+    // only used on the render thread while updating the paint node, which
+    // reads nothing else of the engine or the pending moves
+    std::shared_ptr<const RenderSnapshot> m_renderSnapshot;
+    std::shared_ptr<const ProvisionalSnapshot> m_renderProvisionalSnapshot;
+    quint64 m_legalMovesVersion;
+    quint64 m_threatsVersion;
+    bool m_transformDirty;
     bool m_gridDirty;
     bool m_dotsDirty;
     bool m_dotImagesDirty;
     bool m_linesDirty;
+    bool m_chainsDirty;
+    bool m_provisionalDirty;
     bool m_lineMaterialsDirty;
+    bool m_viewportDirty;
+    bool m_legalMovesDirty;
+    bool m_threatsDirty;
 };
 
 #endif // GAMEBOARD_H
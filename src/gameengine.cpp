@@ -2,12 +2,20 @@
 #include "dot.h"
 #include "dotcoordinatespredicate.h"
 #include "dotonborderpredicate.h"
+#include "instrumentation.h"
 #include "line.h"
 #include "lineendpointspredicate.h"
+#include "movelog.h"
+#include "rendersnapshot.h"
+#include "tracing.h"
 #include <QPoint>
 #include <algorithm>
+#include <limits>
+#include <queue>
+#include <random>
 #include <set>
 #include <stack>
+#include <unordered_map>
 
 GameEngine::GameEngine(QObject *parent)
     : QObject(parent)
@@ -18,11 +26,34 @@ GameEngine::GameEngine(QObject *parent)
     , m_turnsLeft(0)
     , m_currentPlayer(0)
     , m_stage(PlaceDotStage)
+    , m_metricsEnabled(false)
+    , m_copied(false)
+    , m_moveLog(new MoveLog(this))
+    , m_dotModel(new DotListModel(this))
+    , m_lineModel(new LineListModel(this))
+    , m_playerModel(new PlayerListModel(m_numPlayers, this))
+    , m_moveHistoryModel(new MoveHistoryModel(this))
+    , m_renderSnapshotVersion(0)
+    , m_renderSnapshotRetainCount(0)
+    , m_threatsRetainCount(0)
 {
+    for (std::atomic<quint64> &metric : m_metrics) {
+        metric.store(0, std::memory_order_relaxed);
+    }
+
+    // until a game starts, the board is a single point where nothing can be
+    // placed
+    m_placeablePoints = QBitArray(1, false);
+    m_dotsByPoint.assign(1, nullptr);
+    m_connectionsByPoint.resize(1);
+    m_threatMap.reset(m_numPlayers, 0, 0);
+    resetPositionKey(0, 0);
+
     m_playerNames.resize(m_numPlayers);
 
     for (int i = 0; i < m_numPlayers; ++i) {
         m_playerNames[i] = "Player " + QString::number(i + 1);
+        m_playerModel->setName(i, m_playerNames[i]);
     }
 
     m_playerScores.resize(m_numPlayers);
@@ -91,6 +122,7 @@ void GameEngine::setPlayerNames(QVariantList &list)
 
         for (int i = 0; i < m_numPlayers; ++i) {
             m_playerNames[i] = list.at(i).toString();
+            m_playerModel->setName(i, m_playerNames[i]);
         }
 
         emit playerNamesChanged();
@@ -108,9 +140,65 @@ QVariantList GameEngine::playerScores() const
     return list;
 }
 
+DotListModel *GameEngine::dotModel() const
+{
+    return m_dotModel;
+}
+
+LineListModel *GameEngine::lineModel() const
+{
+    return m_lineModel;
+}
+
+PlayerListModel *GameEngine::playerModel() const
+{
+    return m_playerModel;
+}
+
+MoveHistoryModel *GameEngine::moveHistoryModel() const
+{
+    return m_moveHistoryModel;
+}
+
+MoveLog *GameEngine::moveLog() const
+{
+    return m_moveLog;
+}
+
+bool GameEngine::metricsEnabled() const
+{
+    return m_metricsEnabled;
+}
+
+void GameEngine::setMetricsEnabled(bool enabled)
+{
+    m_metricsEnabled = enabled;
+}
+
+QVariantMap GameEngine::takeMetrics()
+{
+    static const char *const names[] = {"findDot",
+                                        "findLine",
+                                        "findPathExpansions",
+                                        "completeChain",
+                                        "captureCells",
+                                        "connectionPathExpansions",
+                                        "threatPoints"};
+    QVariantMap metrics;
+
+    for (int i = 0; i < MetricCount; ++i) {
+        metrics.insert(
+            names[i],
+            static_cast<qulonglong>(
+                m_metrics[i].exchange(0, std::memory_order_relaxed)));
+    }
+
+    return metrics;
+}
+
 const Dot *GameEngine::getDotAt(int x, int y) const
 {
-    return findDot(m_dots, x, y);
+    return findDot(x, y);
 }
 
 std::vector<const Dot *> GameEngine::getDots() const
@@ -158,9 +246,44 @@ std::vector<std::vector<const Dot *>> GameEngine::getChains() const
     return outChains;
 }
 
+std::shared_ptr<const RenderSnapshot> GameEngine::renderSnapshot() const
+{
+    return std::atomic_load(&m_renderSnapshot);
+}
+
+void GameEngine::retainRenderSnapshot()
+{
+    ++m_renderSnapshotRetainCount;
+
+    if (m_renderSnapshotRetainCount == 1) {
+        publishRenderSnapshot();
+    }
+}
+
+void GameEngine::releaseRenderSnapshot()
+{
+    --m_renderSnapshotRetainCount;
+}
+
+void GameEngine::retainThreats()
+{
+    ++m_threatsRetainCount;
+
+    if (m_threatsRetainCount == 1) {
+        publishRenderSnapshot();
+    }
+}
+
+void GameEngine::releaseThreats()
+{
+    --m_threatsRetainCount;
+}
+
 bool GameEngine::canPlaceDot(int x, int y) const
 {
-    return isPointActive(x, y) && findDot(m_dots, x, y) == nullptr;
+    const int index = findPointIndex(x, y);
+
+    return index >= 0 && m_placeablePoints.testBit(index);
 }
 
 bool GameEngine::canConnectDots(const Dot &dot1, const Dot &dot2) const
@@ -181,32 +304,173 @@ bool GameEngine::canConnectDots(const Dot &dot1, const Dot &dot2) const
     }
 
     // check if the dots are neighbours and are not yet connected
-    if (!dot1.isNeighbor(dot2) || findLine(&dot1, &dot2) != nullptr
-        || connectedInChain(dot1, dot2)) {
+    if (!dot1.isNeighbor(dot2) || areConnected(dot1, dot2)) {
         return false;
     }
 
-    if (dot1.x() == dot2.x() || dot1.y() == dot2.y()) {
-        // horizontal or vertical line
-        return true;
-    } else {
-        // diagonal line
+    // check if a diagonal would cross another connection
+    return !crossesConnection(dot1, dot2);
+}
 
-        const Dot *blockingDot1 = findDot(m_dots, dot1.x(), dot2.y());
-        const Dot *blockingDot2 = findDot(m_dots, dot2.x(), dot1.y());
+std::vector<Dot> GameEngine::findConnectionPath(
+    const Dot &from,
+    const Dot &to,
+    const std::vector<Dot> &avoidedDots) const
+{
+    // Implementation note: A* over the current player's dots, with each
+    // connection costing one step; the Chebyshev distance to the target is
+    // then a lower bound on the remaining cost
 
-        if (blockingDot1 == nullptr || blockingDot2 == nullptr) {
-            return true;
+    std::vector<Dot> path;
+    const int start = findPointIndex(from.x(), from.y());
+    const int goal = findPointIndex(to.x(), to.y());
+
+    if (start < 0 || goal < 0 || start == goal
+        || m_dotsByPoint[start] == nullptr) {
+        return path;
+    }
+
+    const int pointCount = static_cast<int>(m_dotsByPoint.size());
+    const int width = m_columns + 1;
+    const auto estimate = [&](int index) {
+        return qMax(qAbs(index % width - to.x()), qAbs(index / width - to.y()));
+    };
+    std::vector<bool> avoided(pointCount, false);
+    std::vector<int> costs(pointCount, std::numeric_limits<int>::max());
+    std::vector<int> previous(pointCount, -1);
+    std::priority_queue<
+        std::pair<int, int>,
+        std::vector<std::pair<int, int>>,
+        std::greater<std::pair<int, int>>>
+        open;
+
+    for (const Dot &dot : avoidedDots) {
+        const int index = findPointIndex(dot.x(), dot.y());
+
+        if (index >= 0) {
+            avoided[index] = true;
         }
+    }
 
-        const Line *blockingLine = findLine(blockingDot1, blockingDot2);
+    costs[start] = 0;
+    open.push(std::make_pair(estimate(start), start));
 
-        if (blockingLine == nullptr) {
-            return true;
+    while (!open.empty()) {
+        const int index = open.top().second;
+        const int cost = open.top().first - estimate(index);
+
+        open.pop();
+
+        if (index == goal) {
+            break;
+        }
+
+        // skip entries superseded by a cheaper path to the same dot
+        if (cost > costs[index]) {
+            continue;
+        }
+
+        countMetric(ConnectionPathExpansionMetric);
+
+        const Dot *dot = m_dotsByPoint[index];
+
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                const int next = findPointIndex(dot->x() + dx, dot->y() + dy);
+
+                if (next < 0 || costs[next] <= cost + 1
+                    || (avoided[next] && next != goal)) {
+                    continue;
+                }
+
+                const Dot *nextDot = m_dotsByPoint[next];
+
+                if (nextDot == nullptr || !canConnectDots(*dot, *nextDot)) {
+                    continue;
+                }
+
+                costs[next] = cost + 1;
+                previous[next] = index;
+                open.push(std::make_pair(costs[next] + estimate(next), next));
+            }
         }
     }
 
-    return false;
+    if (previous[goal] < 0) {
+        return path;
+    }
+
+    for (int index = goal; index >= 0; index = previous[index]) {
+        path.push_back(*m_dotsByPoint[index]);
+    }
+
+    std::reverse(path.begin(), path.end());
+
+    return path;
+}
+
+void GameEngine::copyGame(const GameEngine &other)
+{
+    clearTurnData();
+    clearGameData();
+
+    m_copied = true;
+    m_rows = other.m_rows;
+    m_columns = other.m_columns;
+    m_turnLimit = other.m_turnLimit;
+    m_turnsLeft = other.m_turnsLeft;
+    m_currentPlayer = other.m_currentPlayer;
+    m_stage = other.m_stage;
+    m_playerNames = other.m_playerNames;
+    m_playerScores = other.m_playerScores;
+    m_pointDisabled = other.m_pointDisabled;
+    m_placeablePoints = other.m_placeablePoints;
+
+    {
+        QMutexLocker locker(&other.m_threatMapMutex);
+
+        m_threatMap = other.m_threatMap;
+    }
+
+    m_positionKeys = other.m_positionKeys;
+    m_symmetryKeys = other.m_symmetryKeys;
+    m_dotsByPoint.assign(other.m_dotsByPoint.size(), nullptr);
+    m_connectionsByPoint.assign(other.m_connectionsByPoint.size(), {});
+
+    // the copies are found by point, as every dot has a point of its own
+    auto copyOf = [this](const Dot *dot) {
+        return m_dotsByPoint[findPointIndex(dot->x(), dot->y())];
+    };
+
+    for (const Dot *dot : other.m_dots) {
+        Dot *copy = new Dot(*dot);
+
+        m_dots.push_back(copy);
+        m_dotsByPoint[findPointIndex(dot->x(), dot->y())] = copy;
+    }
+
+    for (std::size_t i = 0; i < other.m_connectionsByPoint.size(); ++i) {
+        for (const Dot *dot : other.m_connectionsByPoint[i]) {
+            m_connectionsByPoint[i].push_back(copyOf(dot));
+        }
+    }
+
+    for (const Line *line : other.m_lines) {
+        m_lines.push_back(
+            new Line(*copyOf(&line->endpoint1()), *copyOf(&line->endpoint2())));
+    }
+
+    for (const std::deque<Dot *> *chain : other.m_chains) {
+        std::deque<Dot *> *copy = new std::deque<Dot *>();
+
+        for (const Dot *dot : *chain) {
+            copy->push_back(copyOf(dot));
+        }
+
+        m_chains.push_back(copy);
+    }
+
+    publishRenderSnapshot();
 }
 
 template <typename InputIterator>
@@ -231,12 +495,23 @@ bool GameEngine::neighborsInChain(
 
 void GameEngine::newGame(int rows, int columns, int turnLimit)
 {
-    clearGameData();
     clearTurnData();
+    clearGameData();
     m_pointDisabled = QBitArray((rows + 1) * (columns + 1), false);
+    m_placeablePoints = QBitArray((rows + 1) * (columns + 1), true);
+    m_dotsByPoint.assign((rows + 1) * (columns + 1), nullptr);
+    m_connectionsByPoint.assign((rows + 1) * (columns + 1), {});
+    m_threatMap.reset(m_numPlayers, rows, columns);
+    resetPositionKey(rows, columns);
 
     m_rows = rows;
     m_columns = columns;
+    m_copied = false;
+
+    m_moveLog->append(MoveLog::NewGameEvent, -1, columns, rows);
+    m_dotModel->clear();
+    m_lineModel->clear();
+    m_moveHistoryModel->clear();
 
     emit gameStarted();
 
@@ -255,13 +530,21 @@ void GameEngine::newGame(int rows, int columns, int turnLimit)
 
     for (int i = 0; i < m_numPlayers; ++i) {
         m_playerScores[i] = 0;
+        m_playerModel->setScore(i, 0);
     }
 
     emit playerScoresChanged();
+
+    publishRenderSnapshot();
 }
 
 bool GameEngine::placeDot(int x, int y)
 {
+    // the counters are shared by every engine, and the copies the searches
+    // try moves on would drown out the moves of the game being played
+    INSTRUMENT_TIME_IF(PlaceDotTime, !m_copied);
+    TRACE_SPAN("GameEngine::placeDot");
+
     if (m_stage != PlaceDotStage) {
         return false;
     }
@@ -270,16 +553,18 @@ bool GameEngine::placeDot(int x, int y)
         return false;
     }
 
-    qDebug(
-        "%s::%s: player %d places (%d, %d)",
-        metaObject()->className(),
-        __func__,
-        m_currentPlayer,
-        x,
-        y);
+    recordMove(MoveLog::PlaceDotEvent, m_currentPlayer, x, y);
 
     Dot *dot = new Dot(m_currentPlayer, x, y, true);
     m_dots.push_back(dot);
+    m_placeablePoints.clearBit(findPointIndex(x, y));
+    m_dotsByPoint[findPointIndex(x, y)] = dot;
+    m_threatMap.markChanged(x, y);
+    togglePointKey(x, y, m_currentPlayer);
+
+    if (!m_copied) {
+        m_dotModel->appendDot(*dot);
+    }
 
     emit dotsChanged();
 
@@ -287,17 +572,22 @@ bool GameEngine::placeDot(int x, int y)
 
     emit stageChanged();
 
+    publishRenderSnapshot();
+
     return true;
 }
 
 bool GameEngine::connectDots(int x1, int y1, int x2, int y2)
 {
+    INSTRUMENT_TIME_IF(ConnectDotsTime, !m_copied);
+    TRACE_SPAN("GameEngine::connectDots");
+
     if (m_stage != ConnectDotsStage) {
         return false;
     }
 
-    Dot *dot1 = findDot(m_dots, x1, y1);
-    Dot *dot2 = findDot(m_dots, x2, y2);
+    Dot *dot1 = findDot(x1, y1);
+    Dot *dot2 = findDot(x2, y2);
 
     // check if the dots exist
     if (dot1 == nullptr || dot2 == nullptr) {
@@ -308,15 +598,7 @@ bool GameEngine::connectDots(int x1, int y1, int x2, int y2)
         return false;
     }
 
-    qDebug(
-        "%s::%s: player %d connects (%d, %d) -> (%d, %d)",
-        metaObject()->className(),
-        __func__,
-        m_currentPlayer,
-        x1,
-        y1,
-        x2,
-        y2);
+    recordMove(MoveLog::ConnectDotsEvent, m_currentPlayer, x1, y1, x2, y2);
 
     std::deque<Dot *> chain = addToChains(*dot1, *dot2);
 
@@ -333,74 +615,145 @@ bool GameEngine::connectDots(int x1, int y1, int x2, int y2)
         }
     }
 
+    publishRenderSnapshot();
+
     return true;
 }
 
 void GameEngine::connectAllDots()
 {
+    INSTRUMENT_TIME_IF(ConnectAllDotsTime, !m_copied);
+    TRACE_SPAN("GameEngine::connectAllDots");
+
     if (m_stage != ConnectDotsStage) {
         return;
     }
 
-    std::stack<const Dot *> unvisited;
-    std::set<const Dot *> visited;
+    // every unordered pair of neighbouring points is reached exactly once
+    // through these four offsets
+    static const QPoint forwardOffsets[] = {
+        QPoint(1, 0),
+        QPoint(1, 1),
+        QPoint(0, 1),
+        QPoint(-1, 1),
+    };
 
-    for (const Dot *dot : m_dots) {
-        if (dot->player() == m_currentPlayer) {
-            unvisited.push(dot);
+    std::vector<std::pair<Dot *, Dot *>> edges;
+
+    for (Dot *dot : m_dots) {
+        if (dot->player() != m_currentPlayer || !dot->isActive()) {
+            continue;
         }
-    }
 
-    while (!unvisited.empty()) {
-        const Dot *currentDot = unvisited.top();
+        for (const QPoint &offset : forwardOffsets) {
+            const int x = dot->x() + offset.x();
+            const int y = dot->y() + offset.y();
+            const int index = findPointIndex(x, y);
 
-        unvisited.pop();
-
-        const std::deque<QPoint> adjacentPoints = {
-            QPoint(currentDot->x() + 1, currentDot->y()),
-            QPoint(currentDot->x() + 1, currentDot->y() - 1),
-            QPoint(currentDot->x(), currentDot->y() - 1),
-            QPoint(currentDot->x() - 1, currentDot->y() - 1),
-            QPoint(currentDot->x() - 1, currentDot->y()),
-            QPoint(currentDot->x() - 1, currentDot->y() + 1),
-            QPoint(currentDot->x(), currentDot->y() + 1),
-            QPoint(currentDot->x() + 1, currentDot->y() + 1),
-        };
-
-        for (const QPoint adjacentPoint : adjacentPoints) {
-            if (!connectDots(
-                    currentDot->x(),
-                    currentDot->y(),
-                    adjacentPoint.x(),
-                    adjacentPoint.y())) {
+            if (index < 0) {
                 continue;
             }
 
-            const Dot *adjacentDot =
-                findDot(m_dots, adjacentPoint.x(), adjacentPoint.y());
+            Dot *adjacentDot = m_dotsByPoint[index];
 
-            Q_ASSERT(adjacentDot != nullptr);
+            if (adjacentDot == nullptr
+                || adjacentDot->player() != m_currentPlayer
+                || !adjacentDot->isActive()
+                || areConnected(*dot, *adjacentDot)) {
+                continue;
+            }
 
-            if (visited.find(adjacentDot) != visited.cend()) {
-                unvisited.push(adjacentDot);
+            // the connections accepted earlier in this batch are already in
+            // the index, so a diagonal cannot cross one of them either
+            if (crossesConnection(*dot, *adjacentDot)) {
+                continue;
             }
+
+            addConnection(*dot, *adjacentDot);
+            edges.emplace_back(dot, adjacentDot);
         }
+    }
 
-        visited.insert(currentDot);
+    if (edges.empty()) {
+        return;
     }
+
+    // commit the edges to the chains, extending a chain wherever an edge
+    // meets one of its ends
+    std::unordered_multimap<const Dot *, std::deque<Dot *> *> chainEnds;
+
+    for (std::deque<Dot *> *chain : m_chains) {
+        chainEnds.emplace(chain->front(), chain);
+        chainEnds.emplace(chain->back(), chain);
+    }
+
+    for (const std::pair<Dot *, Dot *> &edge : edges) {
+        Dot *dot1 = edge.first;
+        Dot *dot2 = edge.second;
+
+        recordMove(
+            MoveLog::ConnectDotsEvent,
+            m_currentPlayer,
+            dot1->x(),
+            dot1->y(),
+            dot2->x(),
+            dot2->y());
+
+        auto it = chainEnds.find(dot1);
+
+        if (it == chainEnds.end()) {
+            std::swap(dot1, dot2);
+            it = chainEnds.find(dot1);
+        }
+
+        std::deque<Dot *> *chain;
+
+        if (it != chainEnds.end()) {
+            chain = it->second;
+
+            // an edge between the two ends of a chain closes it, leaving the
+            // same dot at its front and back, both of which stay ends
+            if (chain->front() == dot1) {
+                chain->push_front(dot2);
+            } else {
+                chain->push_back(dot2);
+            }
+
+            chainEnds.erase(it);
+            chainEnds.emplace(dot2, chain);
+        } else {
+            chain = new std::deque<Dot *>{dot1, dot2};
+
+            m_chains.push_back(chain);
+            chainEnds.emplace(dot1, chain);
+            chainEnds.emplace(dot2, chain);
+        }
+    }
+
+    emit chainsChanged();
+
+    // every enclosure or barricade formed by the batch runs through one of
+    // its edges, so each edge is searched once, unless an enclosure or
+    // barricade found through an earlier one has already finalized it
+    for (const std::pair<Dot *, Dot *> &edge : edges) {
+        if (connectedInChain(*edge.first, *edge.second)) {
+            completeSegment(*edge.first, *edge.second);
+        }
+    }
+
+    publishRenderSnapshot();
 }
 
 void GameEngine::endTurn()
 {
+    INSTRUMENT_TIME_IF(EndTurnTime, !m_copied);
+    TRACE_SPAN("GameEngine::endTurn");
+
     if (m_turnsLeft <= 0) {
         return;
     }
 
-    qDebug(
-        "%s::%s: player %d ends turn",
-        metaObject()->className(),
-        __func__,
-        m_currentPlayer);
+    recordMove(MoveLog::EndTurnEvent, m_currentPlayer);
 
     clearTurnData();
 
@@ -413,8 +766,10 @@ void GameEngine::endTurn()
     }
 
     if (m_turnsLeft > 0) {
+        togglePlayerKey(m_currentPlayer);
         m_currentPlayer =
             ++m_currentPlayer == m_numPlayers ? 0 : m_currentPlayer;
+        togglePlayerKey(m_currentPlayer);
 
         emit currentPlayerChanged();
 
@@ -426,16 +781,30 @@ void GameEngine::endTurn()
 
         emit stageChanged();
     }
-}
 
-bool GameEngine::isPointActive(int x, int y) const
-{
-    return !m_pointDisabled[y * (m_columns + 1) + x];
+    publishRenderSnapshot();
 }
 
 void GameEngine::deactivatePoint(int x, int y)
 {
+    // captured areas can overlap, and the key must only change once
+    if (m_pointDisabled[y * (m_columns + 1) + x]) {
+        return;
+    }
+
     m_pointDisabled[y * (m_columns + 1) + x] = true;
+    m_placeablePoints.clearBit(y * (m_columns + 1) + x);
+    m_threatMap.markChanged(x, y);
+    togglePointKey(x, y, m_numPlayers);
+}
+
+int GameEngine::findPointIndex(int x, int y) const
+{
+    if (x < 0 || x > m_columns || y < 0 || y > m_rows) {
+        return -1;
+    }
+
+    return y * (m_columns + 1) + x;
 }
 
 bool GameEngine::connectedInChain(const Dot &dot1, const Dot &dot2) const
@@ -445,6 +814,8 @@ bool GameEngine::connectedInChain(const Dot &dot1, const Dot &dot2) const
 
 std::deque<Dot *> &GameEngine::addToChains(Dot &dot1, Dot &dot2)
 {
+    addConnection(dot1, dot2);
+
     for (std::deque<Dot *> *chain : m_chains) {
         bool inserted = false;
 
@@ -518,6 +889,9 @@ void GameEngine::cutChain(std::deque<Dot *> *&chain, Dot &dot1, Dot &dot2)
 template <typename InputIterator>
 void GameEngine::completeChain(InputIterator chainStart, InputIterator chainEnd)
 {
+    TRACE_SPAN("GameEngine::completeChain");
+    countMetric(CompleteChainMetric);
+
     bool completed = false;
     bool surrounded = false;
     std::deque<Dot *> closedChain;
@@ -535,7 +909,9 @@ void GameEngine::completeChain(InputIterator chainStart, InputIterator chainEnd)
             surrounded = true;
         } else {
             // try forming a barricade
-            if (formBarricade(chainStart, chainEnd)) {
+            std::deque<Dot *> barricade;
+
+            if (formBarricade(chainStart, chainEnd, barricade)) {
                 completed = true;
             }
         }
@@ -552,12 +928,40 @@ void GameEngine::completeChain(InputIterator chainStart, InputIterator chainEnd)
     }
 }
 
+void GameEngine::completeSegment(Dot &dot1, Dot &dot2)
+{
+    TRACE_SPAN("GameEngine::completeSegment");
+    countMetric(CompleteChainMetric);
+
+    std::deque<Dot *> segment = {&dot1, &dot2};
+    std::deque<Dot *> completedChain;
+
+    // any other path between the dots closes an enclosure with the segment
+    if (findPath(
+            segment.begin(),
+            segment.end() - 1,
+            DotCoordinatesPredicate(dot2.x(), dot2.y()),
+            completedChain)) {
+        completedChain.push_back(&dot1);
+        captureArea(completedChain.begin(), completedChain.end() - 1);
+    } else if (!formBarricade(
+                   segment.begin(), segment.end() - 1, completedChain)) {
+        return;
+    }
+
+    finalizeChain(completedChain.begin(), completedChain.end() - 1);
+
+    emit linesChanged();
+}
+
 template <typename InputIterator>
 bool GameEngine::closeChain(
     InputIterator chainStart,
     InputIterator chainEnd,
     std::deque<Dot *> &outChain) const
 {
+    TRACE_SPAN("GameEngine::closeChain");
+
     // initialize the output chain to contain all dots from the input chain
     outChain.clear();
     outChain.insert(outChain.end(), chainStart, chainEnd + 1);
@@ -595,12 +999,18 @@ bool GameEngine::closeChain(
 }
 
 template <typename InputIterator>
-bool GameEngine::formBarricade(InputIterator chainStart, InputIterator chainEnd)
-    const
+bool GameEngine::formBarricade(
+    InputIterator chainStart,
+    InputIterator chainEnd,
+    std::deque<Dot *> &outChain) const
 {
-    std::deque<Dot *> extendedChain;
+    TRACE_SPAN("GameEngine::formBarricade");
+
+    std::deque<Dot *> &extendedChain = outChain;
 
     // try to extend the chain to the borders
+    outChain.clear();
+
     if (!extendToBorders(chainStart, chainEnd, extendedChain)) {
         return false;
     }
@@ -712,6 +1122,11 @@ void GameEngine::finalizeChain(InputIterator chainStart, InputIterator chainEnd)
             if ((foundChain = findChain(dot1, dot2)) != nullptr) {
                 cutChain(foundChain, dot1, dot2);
                 m_lines.push_back(new Line(dot1, dot2));
+                toggleSegmentKey(dot1, dot2);
+
+                if (!m_copied) {
+                    m_lineModel->appendLine(*m_lines.back());
+                }
             }
         }
     }
@@ -720,6 +1135,8 @@ void GameEngine::finalizeChain(InputIterator chainStart, InputIterator chainEnd)
 template <typename InputIterator>
 void GameEngine::captureArea(InputIterator chainStart, InputIterator chainEnd)
 {
+    TRACE_SPAN("GameEngine::captureArea");
+
     InputIterator it;
     int minY = m_rows;
     int maxY = 0;
@@ -757,14 +1174,21 @@ void GameEngine::captureArea(InputIterator chainStart, InputIterator chainEnd)
     bool captured = false;
 
     for (y = minY + 1; y < maxY; ++y) {
+        countMetric(
+            CaptureCellMetric, qMax(0, rightBounds[y] - leftBounds[y] - 1));
+
         for (x = leftBounds[y] + 1; x < rightBounds[y]; ++x) {
-            dot = findDot(m_dots, x, y);
+            dot = findDot(x, y);
 
             if (dot != nullptr) {
                 if (dot->player() != m_currentPlayer && dot->isActive()) {
                     m_playerScores[m_currentPlayer] += 10;
                     dot->deactivate();
                     captured = true;
+
+                    if (!m_copied) {
+                        m_dotModel->deactivateDot(x, y);
+                    }
                 }
             }
 
@@ -773,25 +1197,28 @@ void GameEngine::captureArea(InputIterator chainStart, InputIterator chainEnd)
     }
 
     if (captured) {
+        if (!m_copied) {
+            m_playerModel->setScore(
+                m_currentPlayer, m_playerScores[m_currentPlayer]);
+        }
+
         emit playerScoresChanged();
     }
 }
 
-Dot *GameEngine::findDot(const std::deque<Dot *> &dots, int x, int y) const
+Dot *GameEngine::findDot(int x, int y) const
 {
-    DotCoordinatesPredicate pred(x, y);
-    std::deque<Dot *>::const_iterator it =
-        std::find_if(dots.begin(), dots.end(), pred);
+    countMetric(FindDotMetric);
 
-    if (it != dots.end()) {
-        return *it;
-    } else {
-        return nullptr;
-    }
+    const int index = findPointIndex(x, y);
+
+    return index >= 0 ? m_dotsByPoint[index] : nullptr;
 }
 
 Line *GameEngine::findLine(const Dot *endpoint1, const Dot *endpoint2) const
 {
+    countMetric(FindLineMetric);
+
     const std::deque<Line *> &lines = m_lines;
     LineEndpointsPredicate pred(endpoint1, endpoint2);
     std::deque<Line *>::const_iterator it =
@@ -804,26 +1231,6 @@ Line *GameEngine::findLine(const Dot *endpoint1, const Dot *endpoint2) const
     }
 }
 
-std::deque<Line *> GameEngine::findLines(const Dot &endpoint) const
-{
-    std::deque<Line *> matches;
-    const std::deque<Line *> &lines = m_lines;
-    std::deque<Line *>::const_iterator it = lines.begin();
-    std::deque<Line *>::const_iterator end = lines.end();
-    LineEndpointsPredicate pred(&endpoint);
-
-    while (it != end) {
-        it = std::find_if(it, end, pred);
-
-        if (it != end) {
-            matches.push_back(*it);
-            ++it; // start checking from next element
-        }
-    }
-
-    return matches;
-}
-
 std::deque<Dot *> *GameEngine::findChain(const Dot &dot1, const Dot &dot2) const
 {
     const std::list<std::deque<Dot *> *> &chains = m_chains;
@@ -837,51 +1244,192 @@ std::deque<Dot *> *GameEngine::findChain(const Dot &dot1, const Dot &dot2) const
     return nullptr;
 }
 
-std::deque<Dot *> GameEngine::findConnectedDots(const Dot &dot) const
+const std::vector<Dot *> &GameEngine::findConnectedDots(const Dot &dot) const
 {
-    std::deque<Dot *> connectedDots;
+    return m_connectionsByPoint[findPointIndex(dot.x(), dot.y())];
+}
 
-    // find connected dots in the existing lines
-    {
-        const std::deque<Line *> &lines = findLines(dot);
+bool GameEngine::areConnected(const Dot &dot1, const Dot &dot2) const
+{
+    const std::vector<Dot *> &connectedDots = findConnectedDots(dot1);
 
-        for (const Line *pLine : lines) {
-            const Line &line = *pLine;
+    return std::find(connectedDots.begin(), connectedDots.end(), &dot2)
+        != connectedDots.end();
+}
 
-            if (&line.endpoint1() != &dot) {
-                connectedDots.push_back(&line.endpoint1());
-            } else {
-                connectedDots.push_back(&line.endpoint2());
-            }
-        }
+bool GameEngine::crossesConnection(const Dot &dot1, const Dot &dot2) const
+{
+    // only a diagonal can cross another connection
+    if (dot1.x() == dot2.x() || dot1.y() == dot2.y()) {
+        return false;
     }
 
-    // find connected dots in all chains
-    {
-        const std::list<std::deque<Dot *> *> &chains = m_chains;
-
-        for (const std::deque<Dot *> *chain : chains) {
-            std::deque<Dot *>::const_iterator begin = chain->begin();
-            std::deque<Dot *>::const_iterator end = chain->end();
-            bool found = false;
-
-            for (std::deque<Dot *>::const_iterator it = begin;
-                 !found && it != end;
-                 ++it) {
-                if (*it == &dot) {
-                    if (it - 1 != begin - 1) {
-                        connectedDots.push_back(*(it - 1));
-                    }
-                    if (it + 1 != end) {
-                        connectedDots.push_back(*(it + 1));
-                    }
-                    found = true;
-                }
-            }
-        }
+    const Dot *blockingDot1 = findDot(dot1.x(), dot2.y());
+    const Dot *blockingDot2 = findDot(dot2.x(), dot1.y());
+
+    return blockingDot1 != nullptr && blockingDot2 != nullptr
+        && areConnected(*blockingDot1, *blockingDot2);
+}
+
+QBitArray GameEngine::threatenedPoints(int player) const
+{
+    QMutexLocker locker(&m_threatMapMutex);
+
+    updateThreatMap();
+
+    return m_threatMap.threatenedPoints(player);
+}
+
+quint64 GameEngine::positionKey() const
+{
+    return m_symmetryKeys[0];
+}
+
+int GameEngine::symmetryCount() const
+{
+    return static_cast<int>(m_symmetryKeys.size());
+}
+
+QPoint GameEngine::transformPoint(int symmetry, const QPoint &point) const
+{
+    if (findPointIndex(point.x(), point.y()) < 0) {
+        return point;
     }
 
-    return connectedDots;
+    const int x = symmetry & 1 ? m_columns - point.x() : point.x();
+    const int y = symmetry & 2 ? m_rows - point.y() : point.y();
+
+    return symmetry & 4 ? QPoint(y, x) : QPoint(x, y);
+}
+
+int GameEngine::canonicalSymmetry() const
+{
+    return static_cast<int>(
+        std::min_element(m_symmetryKeys.begin(), m_symmetryKeys.end())
+        - m_symmetryKeys.begin());
+}
+
+quint64 GameEngine::canonicalKey() const
+{
+    return m_symmetryKeys[canonicalSymmetry()];
+}
+
+QPoint GameEngine::toCanonical(const QPoint &point) const
+{
+    return transformPoint(canonicalSymmetry(), point);
+}
+
+QPoint GameEngine::fromCanonical(const QPoint &point) const
+{
+    // the symmetries are their own inverses, except for the two rotations by
+    // a quarter turn, which undo each other
+    const int symmetry = canonicalSymmetry();
+
+    return transformPoint(
+        symmetry == 5 ? 6 : symmetry == 6 ? 5 : symmetry, point);
+}
+
+quint64 GameEngine::pointKey(int pointIndex, int component) const
+{
+    // a dot of each player, the point being captured and four segments
+    return (*m_positionKeys)[pointIndex * (m_numPlayers + 5) + component];
+}
+
+quint64 GameEngine::segmentKey(int x1, int y1, int x2, int y2) const
+{
+    const int index1 = findPointIndex(x1, y1);
+    const int index2 = findPointIndex(x2, y2);
+    const QPoint first = index1 < index2 ? QPoint(x1, y1) : QPoint(x2, y2);
+    const QPoint second = index1 < index2 ? QPoint(x2, y2) : QPoint(x1, y1);
+
+    // the second point follows the first in reading order, so it lies to the
+    // right, below right, below or below left of it
+    int direction;
+
+    if (second.y() == first.y()) {
+        direction = 0;
+    } else if (second.x() > first.x()) {
+        direction = 1;
+    } else if (second.x() == first.x()) {
+        direction = 2;
+    } else {
+        direction = 3;
+    }
+
+    return pointKey(qMin(index1, index2), m_numPlayers + 1 + direction);
+}
+
+quint64 GameEngine::playerKey(int player) const
+{
+    return (*m_positionKeys)[m_positionKeys->size() - m_numPlayers + player];
+}
+
+void GameEngine::resetPositionKey(int rows, int columns)
+{
+    // a fixed seed gives boards of a size the same keys, so that what was
+    // learned about positions in one game still applies in the next
+    std::mt19937_64 generator(POSITION_KEY_SEED);
+    std::shared_ptr<std::vector<quint64>> keys =
+        std::make_shared<std::vector<quint64>>(
+            (rows + 1) * (columns + 1) * (m_numPlayers + 5) + m_numPlayers);
+
+    for (quint64 &key : *keys) {
+        key = generator();
+    }
+
+    m_positionKeys = keys;
+    m_symmetryKeys.assign(rows == columns ? 8 : 4, playerKey(0));
+}
+
+void GameEngine::togglePointKey(int x, int y, int component)
+{
+    for (int i = 0; i < symmetryCount(); ++i) {
+        const QPoint point = transformPoint(i, QPoint(x, y));
+
+        m_symmetryKeys[i] ^=
+            pointKey(findPointIndex(point.x(), point.y()), component);
+    }
+}
+
+void GameEngine::toggleSegmentKey(const Dot &dot1, const Dot &dot2)
+{
+    for (int i = 0; i < symmetryCount(); ++i) {
+        const QPoint point1 = transformPoint(i, QPoint(dot1.x(), dot1.y()));
+        const QPoint point2 = transformPoint(i, QPoint(dot2.x(), dot2.y()));
+
+        m_symmetryKeys[i] ^=
+            segmentKey(point1.x(), point1.y(), point2.x(), point2.y());
+    }
+}
+
+void GameEngine::togglePlayerKey(int player)
+{
+    for (quint64 &key : m_symmetryKeys) {
+        key ^= playerKey(player);
+    }
+}
+
+void GameEngine::addConnection(Dot &dot1, Dot &dot2)
+{
+    m_connectionsByPoint[findPointIndex(dot1.x(), dot1.y())].push_back(&dot2);
+    m_connectionsByPoint[findPointIndex(dot2.x(), dot2.y())].push_back(&dot1);
+    m_threatMap.markChanged(dot1.x(), dot1.y());
+    m_threatMap.markChanged(dot2.x(), dot2.y());
+}
+
+void GameEngine::removeConnection(const Dot &dot1, const Dot &dot2)
+{
+    std::vector<Dot *> &connectedDots1 =
+        m_connectionsByPoint[findPointIndex(dot1.x(), dot1.y())];
+    std::vector<Dot *> &connectedDots2 =
+        m_connectionsByPoint[findPointIndex(dot2.x(), dot2.y())];
+
+    connectedDots1.erase(
+        std::find(connectedDots1.begin(), connectedDots1.end(), &dot2));
+    connectedDots2.erase(
+        std::find(connectedDots2.begin(), connectedDots2.end(), &dot1));
+    m_threatMap.markChanged(dot1.x(), dot1.y());
+    m_threatMap.markChanged(dot2.x(), dot2.y());
 }
 
 template <typename InputIterator, typename Predicate, typename Container>
@@ -912,8 +1460,11 @@ bool GameEngine::findPath(
     while (!unvisited.empty()) {
         const Dot *currentDot = unvisited.top();
 
+        countMetric(FindPathExpansionMetric);
+
         // find all dots connected to the current dot
-        const std::deque<Dot *> &connectedDots = findConnectedDots(*currentDot);
+        const std::vector<Dot *> &connectedDots =
+            findConnectedDots(*currentDot);
 
         Dot *nextDot = nullptr;
 
@@ -957,9 +1508,99 @@ bool GameEngine::findPath(
     return false;
 }
 
+void GameEngine::countMetric(Metric metric, quint64 amount) const
+{
+    if (m_metricsEnabled) {
+        m_metrics[metric].fetch_add(amount, std::memory_order_relaxed);
+    }
+}
+
+void GameEngine::recordMove(
+    MoveLog::EventType type, int player, int x1, int y1, int x2, int y2)
+{
+    if (m_copied) {
+        return;
+    }
+
+    m_moveLog->append(type, player, x1, y1, x2, y2);
+    m_moveHistoryModel->append(type, player, x1, y1, x2, y2);
+}
+
+void GameEngine::publishRenderSnapshot()
+{
+    if (m_renderSnapshotRetainCount == 0) {
+        return;
+    }
+
+    std::shared_ptr<RenderSnapshot> snapshot =
+        std::make_shared<RenderSnapshot>();
+
+    snapshot->version = ++m_renderSnapshotVersion;
+    snapshot->rows = m_rows;
+    snapshot->columns = m_columns;
+    snapshot->currentPlayer = m_currentPlayer;
+    snapshot->placingDot = m_stage == PlaceDotStage;
+
+    // shares the data until the engine next changes the bitset
+    snapshot->placeablePoints = m_placeablePoints;
+
+    // otherwise the threat map is left to be updated when it is next read
+    if (m_threatsRetainCount > 0) {
+        QMutexLocker locker(&m_threatMapMutex);
+
+        snapshot->threatenedPoints.reserve(m_numPlayers);
+
+        updateThreatMap();
+
+        for (int i = 0; i < m_numPlayers; ++i) {
+            snapshot->threatenedPoints.push_back(
+                m_threatMap.threatenedPoints(i));
+        }
+    }
+
+    snapshot->dots.reserve(m_dots.size());
+    snapshot->lines.resize(m_numPlayers);
+    snapshot->chains.reserve(m_chains.size());
+
+    for (const Dot *dot : m_dots) {
+        snapshot->dots.push_back(*dot);
+    }
+
+    for (const Line *line : m_lines) {
+        snapshot->lines[line->endpoint1().player()].push_back(
+            {line->endpoint1(), line->endpoint2()});
+    }
+
+    for (const std::deque<Dot *> *chain : m_chains) {
+        std::vector<Dot> dots;
+
+        for (const Dot *dot : *chain) {
+            dots.push_back(*dot);
+        }
+
+        snapshot->chains.push_back(dots);
+    }
+
+    std::atomic_store(
+        &m_renderSnapshot,
+        std::shared_ptr<const RenderSnapshot>(std::move(snapshot)));
+}
+
+void GameEngine::updateThreatMap() const
+{
+    countMetric(ThreatPointMetric, m_threatMap.update(*this));
+}
+
 void GameEngine::clearTurnData()
 {
+    // segments left in the chains were never finalized into lines
     for (const std::deque<Dot *> *chain : m_chains) {
+        for (std::deque<Dot *>::const_iterator it = chain->begin();
+             it + 1 != chain->end();
+             ++it) {
+            removeConnection(**it, **(it + 1));
+        }
+
         delete chain;
     }
     m_chains.clear();
@@ -971,9 +1612,14 @@ void GameEngine::clearGameData()
         delete dot;
     }
     m_dots.clear();
+    std::fill(m_dotsByPoint.begin(), m_dotsByPoint.end(), nullptr);
 
     for (const Line *line : m_lines) {
         delete line;
     }
     m_lines.clear();
+
+    for (std::vector<Dot *> &connectedDots : m_connectionsByPoint) {
+        connectedDots.clear();
+    }
 }
@@ -1,16 +1,26 @@
 #ifndef GAMEENGINE_H
 #define GAMEENGINE_H
 
+#include "dotlistmodel.h"
+#include "linelistmodel.h"
+#include "movehistorymodel.h"
+#include "playerlistmodel.h"
+#include "threatmap.h"
 #include <QBitArray>
+#include <QMutex>
 #include <QObject>
 #include <QVarLengthArray>
 #include <QVariantList>
+#include <QVariantMap>
+#include <atomic>
 #include <deque>
 #include <list>
+#include <memory>
 #include <vector>
 
 class Dot;
 class Line;
+struct RenderSnapshot;
 
 class GameEngine : public QObject
 {
@@ -26,6 +36,13 @@ class GameEngine : public QObject
                    NOTIFY playerNamesChanged)
     Q_PROPERTY(
         QVariantList playerScores READ playerScores NOTIFY playerScoresChanged)
+    Q_PROPERTY(DotListModel *dotModel READ dotModel CONSTANT)
+    Q_PROPERTY(LineListModel *lineModel READ lineModel CONSTANT)
+    Q_PROPERTY(PlayerListModel *playerModel READ playerModel CONSTANT)
+    Q_PROPERTY(
+        MoveHistoryModel *moveHistoryModel READ moveHistoryModel CONSTANT)
+    Q_PROPERTY(
+        bool metricsEnabled READ metricsEnabled WRITE setMetricsEnabled)
     Q_ENUMS(Stage)
 
 public:
@@ -58,6 +75,28 @@ public:
 
     QVariantList playerScores() const;
 
+    /// Gets the models of the game state, which signal only the rows affected
+    /// by each change so that views can update incrementally.
+    DotListModel *dotModel() const;
+    LineListModel *lineModel() const;
+    PlayerListModel *playerModel() const;
+    MoveHistoryModel *moveHistoryModel() const;
+
+    /// Gets the log of the moves made, which records nothing until it is
+    /// given a file or callback.
+    MoveLog *moveLog() const;
+
+    bool metricsEnabled() const;
+    void setMetricsEnabled(bool enabled);
+
+    /// Takes the hot path counters accumulated since the previous call.
+    ///
+    /// The counters only accumulate while metrics are enabled; otherwise
+    /// each counted operation costs a single branch.
+    ///
+    /// \returns a map from counter names to counts, which are reset to zero.
+    Q_INVOKABLE QVariantMap takeMetrics();
+
     /// Gets the dot with the specified coordinates.
     ///
     /// \returns a pointer to the dot if found, a null pointer otherwise.
@@ -78,6 +117,30 @@ public:
     /// \returns a list of lists which is a snapshot of all the chains.
     std::vector<std::vector<const Dot *>> getChains() const;
 
+    /// Gets the snapshot published after the last change to the game.
+    ///
+    /// Safe to call from any thread; the snapshot is never modified.
+    ///
+    /// \returns the snapshot, or a null pointer if snapshots have never been
+    /// retained.
+    std::shared_ptr<const RenderSnapshot> renderSnapshot() const;
+
+    /// Starts publishing a snapshot after each change to the game, for as
+    /// long as there are more calls to this than to releaseRenderSnapshot().
+    ///
+    /// Only the boards rendering the engine need the snapshots, so the
+    /// engines that moves are tried out on never pay for them.
+    void retainRenderSnapshot();
+    void releaseRenderSnapshot();
+
+    /// Starts including the threatened points in the render snapshots, for
+    /// as long as there are more calls to this than to releaseThreats().
+    ///
+    /// Updating the threat map costs a search of the regions around each
+    /// move, which only a board showing the threats needs after every move.
+    void retainThreats();
+    void releaseThreats();
+
     /// Checks if a dot can be placed at the specified coordinates.
     ///
     /// \returns true if the dot can be placed, false otherwise.
@@ -88,6 +151,86 @@ public:
     /// \returns true if the dots can be connected, false otherwise.
     bool canConnectDots(const Dot &dot1, const Dot &dot2) const;
 
+    /// Checks if the dots are connected by a line or a chain segment.
+    ///
+    /// \returns true if the dots are connected, false otherwise.
+    bool areConnected(const Dot &dot1, const Dot &dot2) const;
+
+    /// Checks if a diagonal between the specified dots would cross a line or
+    /// a chain segment between the other two corners of its cell, which
+    /// canConnectDots() and connectAllDots() both forbid.
+    ///
+    /// \returns true if the connection would cross another, false otherwise.
+    bool crossesConnection(const Dot &dot1, const Dot &dot2) const;
+
+    /// Gets the points which the specified player could capture with their
+    /// next placement and connections, indexed by y * (columns + 1) + x.
+    ///
+    /// The map is brought up to date as it is read, around the points changed
+    /// since it last was; it may be read from several threads at once.
+    ///
+    /// \returns the threatened points.
+    QBitArray threatenedPoints(int player) const;
+
+    /// Gets a hash of the position: the dots, the captured points, the lines
+    /// and the player to move, but not the pending chains.
+    ///
+    /// Equal positions have equal keys and different positions almost never
+    /// do, so the key can index a transposition table.
+    quint64 positionKey() const;
+
+    /// Gets the number of symmetries of the board: 8 for a square board and
+    /// 4 for a rectangular one, the identity included.
+    int symmetryCount() const;
+
+    /// Maps a point by the specified symmetry of the board: 0 is the
+    /// identity, 1 to 3 the reflections in the middle column and row and
+    /// their product, and 4 to 7 those followed by a reflection in the
+    /// diagonal, which only square boards have.
+    ///
+    /// \returns the mapped point, or the point itself if it is off the board.
+    QPoint transformPoint(int symmetry, const QPoint &point) const;
+
+    /// Gets the symmetry that maps the position to its canonical orientation,
+    /// the one of all its orientations with the lowest key.
+    int canonicalSymmetry() const;
+
+    /// Gets the position key of the canonical orientation, which all the
+    /// orientations of a position share.
+    ///
+    /// The keys of the orientations are all updated as the position is, so
+    /// this costs a comparison of as many keys as there are symmetries.
+    quint64 canonicalKey() const;
+
+    /// Maps a point of the position to the canonical orientation, so that a
+    /// move can be stored under canonicalKey().
+    QPoint toCanonical(const QPoint &point) const;
+
+    /// Maps a point of the canonical orientation back to the position.
+    QPoint fromCanonical(const QPoint &point) const;
+
+    /// Finds the shortest sequence of connections from one of the current
+    /// player's dots to another, each of which canConnectDots() allows.
+    ///
+    /// The path does not pass through any of the avoided dots, although it
+    /// may end at one.
+    ///
+    /// \returns the dots of the path from the first dot to the second, or an
+    /// empty list if there is no such path.
+    std::vector<Dot> findConnectionPath(
+        const Dot &from,
+        const Dot &to,
+        const std::vector<Dot> &avoidedDots) const;
+
+    /// Replaces the game with a copy of the other engine's game, so that moves
+    /// can be tried out without touching it.
+    ///
+    /// Only the game state is copied, and no signals are emitted. From then
+    /// on, the engine neither logs its moves nor updates its models, which
+    /// only the engine of the game being played needs, until it starts a new
+    /// game.
+    void copyGame(const GameEngine &other);
+
     /// Checks if the two specified dots are connected in the specified chain.
     ///
     /// \returns true if the two dots are connected, false otherwise.
@@ -118,14 +261,30 @@ signals:
     void turnEnded();
 
 private:
-    /// Checks if the point at the specified coordinates is active.
-    ///
-    /// \returns true if the point is active, false otherwise.
-    bool isPointActive(int x, int y) const;
+    enum Metric
+    {
+        FindDotMetric,
+        FindLineMetric,
+        FindPathExpansionMetric,
+        CompleteChainMetric,
+        CaptureCellMetric,
+        ConnectionPathExpansionMetric,
+        ThreatPointMetric,
+        MetricCount
+    };
+
+    /// Adds to the specified counter if metrics are enabled.
+    void countMetric(Metric metric, quint64 amount = 1) const;
 
     /// Deactivates the point at the specified coordinates.
     void deactivatePoint(int x, int y);
 
+    /// Gets the index of the point at the specified coordinates in the point
+    /// bitsets.
+    ///
+    /// \returns the index, or -1 if the point is off the grid.
+    int findPointIndex(int x, int y) const;
+
     /// Checks if the dots are connected in any chain (i.e. the dots are
     /// side-by-side).
     ///
@@ -153,6 +312,14 @@ private:
     template <typename InputIterator>
     void completeChain(InputIterator chainStart, InputIterator chainEnd);
 
+    /// Completes the enclosure or barricade running through the segment
+    /// between the specified dots, if there is one, finalizing every segment
+    /// along it.
+    ///
+    /// Unlike completeChain(), the segment alone is enough to find an
+    /// enclosure, as any other path between its dots closes one.
+    void completeSegment(Dot &dot1, Dot &dot2);
+
     /// Closes the chain using connections from existing lines and all the
     /// chains. The resultant chain is stored into outChain.
     ///
@@ -163,13 +330,17 @@ private:
         InputIterator chainEnd,
         std::deque<Dot *> &outChain) const;
 
-    /// Forms a barricade off the grid's borders.
+    /// Forms a barricade off the grid's borders. The chain extended to the
+    /// borders is stored into outChain.
     ///
     /// The traversal follows existing lines and all other chains.
     ///
     /// \returns true if a barricade can be formed, false otherwise.
     template <typename InputIterator>
-    bool formBarricade(InputIterator chainStart, InputIterator chainEnd) const;
+    bool formBarricade(
+        InputIterator chainStart,
+        InputIterator chainEnd,
+        std::deque<Dot *> &outChain) const;
 
     /// Extends the chain to the grid's borders using existing lines and all the
     /// chains.
@@ -197,30 +368,55 @@ private:
     template <typename InputIterator>
     void captureArea(InputIterator chainStart, InputIterator chainEnd);
 
-    /// Finds a dot within the given list with coordinates (x,y).
+    /// Finds the dot with coordinates (x,y).
     ///
     /// \returns a pointer to the dot if found, a null pointer otherwise.
-    Dot *findDot(const std::deque<Dot *> &dots, int x, int y) const;
+    Dot *findDot(int x, int y) const;
 
     /// Finds an existing line with the specified endpoints.
     ///
     /// \returns a pointer to the line if found, a null pointer otherwise.
     Line *findLine(const Dot *endpoint1, const Dot *endpoint2 = nullptr) const;
 
-    /// Finds all existing lines containing the specified endpoint.
-    ///
-    /// \returns a list of the lines found.
-    std::deque<Line *> findLines(const Dot &endpoint) const;
-
     /// Finds an existing chain where the two specified dots are connected.
     ///
     /// \returns a pointer to the chain if found, a null pointer otherwise.
     std::deque<Dot *> *findChain(const Dot &dot1, const Dot &dot2) const;
 
-    /// Finds all dots connected to the specified dot.
+    /// Finds all dots connected to the specified dot by a line or a chain.
     ///
     /// \returns a list of the dots found.
-    std::deque<Dot *> findConnectedDots(const Dot &dot) const;
+    const std::vector<Dot *> &findConnectedDots(const Dot &dot) const;
+
+    /// Gets the random number for a component of a point in the position key:
+    /// a dot of each player, the point being captured, or one of the four
+    /// segments starting at the point.
+    quint64 pointKey(int pointIndex, int component) const;
+
+    /// Gets the random number for a line segment in the position key.
+    quint64 segmentKey(int x1, int y1, int x2, int y2) const;
+
+    /// Gets the random number for the player to move in the position key.
+    quint64 playerKey(int player) const;
+
+    /// Makes the random numbers for a board of the specified size, and resets
+    /// the keys to those of the empty board with the first player to move.
+    void resetPositionKey(int rows, int columns);
+
+    /// Toggles a component of a point in the keys of every orientation.
+    void togglePointKey(int x, int y, int component);
+
+    /// Toggles a line segment in the keys of every orientation.
+    void toggleSegmentKey(const Dot &dot1, const Dot &dot2);
+
+    /// Toggles the player to move in the keys of every orientation.
+    void togglePlayerKey(int player);
+
+    /// Records a connection between the dots in the connection index.
+    void addConnection(Dot &dot1, Dot &dot2);
+
+    /// Removes a connection between the dots from the connection index.
+    void removeConnection(const Dot &dot1, const Dot &dot2);
 
     /// Finds a path from the start of the chain to a dot for which the
     /// predicate is true.
@@ -236,6 +432,24 @@ private:
         Predicate pred,
         Container &resultPath) const;
 
+    /// Records a move in the move log and the move history, unless the game
+    /// is a copy.
+    void recordMove(
+        MoveLog::EventType type,
+        int player,
+        int x1 = -1,
+        int y1 = -1,
+        int x2 = -1,
+        int y2 = -1);
+
+    /// Publishes a snapshot of the current state for renderSnapshot(), if
+    /// the snapshots are retained.
+    void publishRenderSnapshot();
+
+    /// Analyses the points changed since the threat map was last updated.
+    /// The caller holds m_threatMapMutex.
+    void updateThreatMap() const;
+
     /// Clears all data pertaining to the turn.
     void clearTurnData();
 
@@ -243,6 +457,7 @@ private:
     void clearGameData();
 
     static const int DEFAULT_NUM_PLAYERS = 2;
+    static const quint64 POSITION_KEY_SEED = Q_UINT64_C(0x9e3779b97f4a7c15);
 
     const int m_numPlayers;
 
@@ -255,9 +470,44 @@ private:
     QVarLengthArray<QString, DEFAULT_NUM_PLAYERS> m_playerNames;
     QVarLengthArray<int, DEFAULT_NUM_PLAYERS> m_playerScores;
     QBitArray m_pointDisabled;
+
+    // active points without a dot, kept up to date as dots are placed and
+    // areas are captured so that checking a placement costs a bit lookup
+    QBitArray m_placeablePoints;
     std::deque<Dot *> m_dots;
+
+    // the dots indexed by point, so that finding one costs a lookup
+    std::vector<Dot *> m_dotsByPoint;
+
+    // the dots connected to each point by a line or a chain segment, so that
+    // traversals cost the degree of a dot rather than a scan of every line
+    std::vector<std::vector<Dot *>> m_connectionsByPoint;
+
+    // the threat map is only updated when it is read, which a const engine
+    // may be from several threads
+    mutable ThreatMap m_threatMap;
+    mutable QMutex m_threatMapMutex;
+
+    // the random numbers of the position key, shared by the copies of a game,
+    // and the key of each orientation of the position, the identity first
+    std::shared_ptr<const std::vector<quint64>> m_positionKeys;
+    std::vector<quint64> m_symmetryKeys;
     std::deque<Line *> m_lines;
     std::list<std::deque<Dot *> *> m_chains;
+    bool m_metricsEnabled;
+
+    // set for a copy of another engine's game, whose moves are only tried out
+    bool m_copied;
+    MoveLog *m_moveLog;
+    DotListModel *m_dotModel;
+    LineListModel *m_lineModel;
+    PlayerListModel *m_playerModel;
+    MoveHistoryModel *m_moveHistoryModel;
+    std::shared_ptr<const RenderSnapshot> m_renderSnapshot;
+    quint64 m_renderSnapshotVersion;
+    int m_renderSnapshotRetainCount;
+    int m_threatsRetainCount;
+    mutable std::atomic<quint64> m_metrics[MetricCount];
 };
 
 #endif // GAMEENGINE_H
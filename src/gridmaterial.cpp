@@ -0,0 +1,194 @@
+#include "gridmaterial.h"
+#include "shaderscale.h"
+#include <QOpenGLShaderProgram>
+#include <QVector2D>
+#include <QVector4D>
+
+namespace
+{
+    class GridMaterialShader : public QSGMaterialShader
+    {
+    public:
+        GridMaterialShader();
+
+        char const *const *attributeNames() const override;
+        void updateState(
+            const RenderState &state,
+            QSGMaterial *newMaterial,
+            QSGMaterial *oldMaterial) override;
+
+    protected:
+        void initialize() override;
+
+    private:
+        int m_matrixId;
+        int m_opacityId;
+        int m_colorId;
+        int m_cellSizeId;
+        int m_strokeWidthId;
+        int m_gridSizeId;
+        int m_pixelSizeId;
+    };
+
+    GridMaterialShader::GridMaterialShader()
+        : m_matrixId(-1)
+        , m_opacityId(-1)
+        , m_colorId(-1)
+        , m_cellSizeId(-1)
+        , m_strokeWidthId(-1)
+        , m_gridSizeId(-1)
+        , m_pixelSizeId(-1)
+    {
+        setShaderSourceFile(
+            QOpenGLShader::Vertex, QStringLiteral(":/shaders/grid.vert"));
+        setShaderSourceFile(
+            QOpenGLShader::Fragment, QStringLiteral(":/shaders/grid.frag"));
+    }
+
+    char const *const *GridMaterialShader::attributeNames() const
+    {
+        static const char *const names[] = {"vertex", "outward", nullptr};
+
+        return names;
+    }
+
+    void GridMaterialShader::updateState(
+        const RenderState &state,
+        QSGMaterial *newMaterial,
+        QSGMaterial *oldMaterial)
+    {
+        QOpenGLShaderProgram *program = QSGMaterialShader::program();
+
+        if (state.isMatrixDirty()) {
+            program->setUniformValue(m_matrixId, state.combinedMatrix());
+            program->setUniformValue(
+                m_pixelSizeId, ShaderScale::pixelSize(state));
+        }
+
+        if (state.isOpacityDirty()) {
+            program->setUniformValue(m_opacityId, state.opacity());
+        }
+
+        const GridMaterial *material = static_cast<GridMaterial *>(newMaterial);
+
+        if (oldMaterial != nullptr && material->compare(oldMaterial) == 0) {
+            return;
+        }
+
+        const QColor color = material->color();
+        const QSize gridSize = material->gridSize();
+
+        program->setUniformValue(
+            m_colorId,
+            QVector4D(
+                static_cast<float>(color.redF() * color.alphaF()),
+                static_cast<float>(color.greenF() * color.alphaF()),
+                static_cast<float>(color.blueF() * color.alphaF()),
+                static_cast<float>(color.alphaF())));
+        program->setUniformValue(
+            m_cellSizeId, static_cast<float>(material->cellSize()));
+        program->setUniformValue(
+            m_strokeWidthId, static_cast<float>(material->strokeWidth()));
+        program->setUniformValue(
+            m_gridSizeId, QVector2D(gridSize.width(), gridSize.height()));
+    }
+
+    void GridMaterialShader::initialize()
+    {
+        QOpenGLShaderProgram *program = QSGMaterialShader::program();
+
+        m_matrixId = program->uniformLocation("qt_Matrix");
+        m_opacityId = program->uniformLocation("qt_Opacity");
+        m_colorId = program->uniformLocation("color");
+        m_cellSizeId = program->uniformLocation("cellSize");
+        m_strokeWidthId = program->uniformLocation("strokeWidth");
+        m_gridSizeId = program->uniformLocation("gridSize");
+        m_pixelSizeId = program->uniformLocation("pixelSize");
+    }
+}
+
+GridMaterial::GridMaterial()
+    : m_color(Qt::black)
+    , m_cellSize(1)
+    , m_strokeWidth(1)
+{
+    setFlag(Blending);
+}
+
+QSGMaterialType *GridMaterial::type() const
+{
+    static QSGMaterialType type;
+
+    return &type;
+}
+
+QSGMaterialShader *GridMaterial::createShader() const
+{
+    return new GridMaterialShader();
+}
+
+int GridMaterial::compare(const QSGMaterial *other) const
+{
+    const GridMaterial *material = static_cast<const GridMaterial *>(other);
+
+    if (m_color != material->m_color) {
+        return m_color.rgba() < material->m_color.rgba() ? -1 : 1;
+    }
+
+    if (!qFuzzyCompare(m_cellSize, material->m_cellSize)) {
+        return m_cellSize < material->m_cellSize ? -1 : 1;
+    }
+
+    if (!qFuzzyCompare(m_strokeWidth, material->m_strokeWidth)) {
+        return m_strokeWidth < material->m_strokeWidth ? -1 : 1;
+    }
+
+    if (m_gridSize != material->m_gridSize) {
+        return m_gridSize.width() * m_gridSize.height()
+                < material->m_gridSize.width() * material->m_gridSize.height()
+            ? -1
+            : 1;
+    }
+
+    return 0;
+}
+
+QColor GridMaterial::color() const
+{
+    return m_color;
+}
+
+void GridMaterial::setColor(const QColor &color)
+{
+    m_color = color;
+}
+
+qreal GridMaterial::cellSize() const
+{
+    return m_cellSize;
+}
+
+void GridMaterial::setCellSize(qreal cellSize)
+{
+    m_cellSize = cellSize;
+}
+
+qreal GridMaterial::strokeWidth() const
+{
+    return m_strokeWidth;
+}
+
+void GridMaterial::setStrokeWidth(qreal strokeWidth)
+{
+    m_strokeWidth = strokeWidth;
+}
+
+QSize GridMaterial::gridSize() const
+{
+    return m_gridSize;
+}
+
+void GridMaterial::setGridSize(const QSize &gridSize)
+{
+    m_gridSize = gridSize;
+}
@@ -0,0 +1,48 @@
+#ifndef GRIDMATERIAL_H
+#define GRIDMATERIAL_H
+
+#include <QColor>
+#include <QSGMaterial>
+#include <QSize>
+
+/// Material which draws the grid lines analytically in the fragment shader.
+///
+/// The geometry is a single quad spanning the grid in grid squares, i.e. from
+/// (0, 0) to (columns, rows), whose texture coordinates give the direction in
+/// which each corner is pushed out to make room for the strokes on the
+/// border. The quad is scaled to pixels by the shader, so resizing the grid
+/// only changes the material.
+///
+/// The shader only runs on the OpenGL renderer; GameBoard draws the grid
+/// lines as rectangles on the others.
+class GridMaterial : public QSGMaterial
+{
+public:
+    GridMaterial();
+
+    QSGMaterialType *type() const override;
+    QSGMaterialShader *createShader() const override;
+    int compare(const QSGMaterial *other) const override;
+
+    QColor color() const;
+    void setColor(const QColor &color);
+
+    /// Gets the size of a grid square in pixels.
+    qreal cellSize() const;
+    void setCellSize(qreal cellSize);
+
+    qreal strokeWidth() const;
+    void setStrokeWidth(qreal strokeWidth);
+
+    /// Gets the number of columns and rows in the grid.
+    QSize gridSize() const;
+    void setGridSize(const QSize &gridSize);
+
+private:
+    QColor m_color;
+    qreal m_cellSize;
+    qreal m_strokeWidth;
+    QSize m_gridSize;
+};
+
+#endif // GRIDMATERIAL_H
@@ -0,0 +1,231 @@
+#include "hintengine.h"
+#include "dot.h"
+#include "gameengine.h"
+#include <QBitArray>
+#include <QVector>
+#include <QtConcurrent>
+#include <functional>
+
+HintEngine::HintEngine(QObject *parent)
+    : QObject(parent)
+    , m_engine(nullptr)
+    , m_busy(false)
+    , m_generation(0)
+    , m_pendingGeneration(0)
+{
+    connect(
+        &m_watcher,
+        &QFutureWatcher<Hint>::finished,
+        this,
+        &HintEngine::finishHint);
+}
+
+HintEngine::~HintEngine()
+{
+    cancel();
+}
+
+GameEngine *HintEngine::engine() const
+{
+    return m_engine;
+}
+
+void HintEngine::setEngine(GameEngine *engine)
+{
+    if (engine == m_engine) {
+        return;
+    }
+
+    cancel();
+
+    if (m_engine != nullptr) {
+        disconnect(m_engine, nullptr, this, nullptr);
+    }
+
+    m_engine = engine;
+
+    if (m_engine != nullptr) {
+        // any move makes the hint being searched for obsolete
+        connect(
+            m_engine, &GameEngine::gameStarted, this, &HintEngine::cancel);
+        connect(m_engine, &GameEngine::dotsChanged, this, &HintEngine::cancel);
+        connect(
+            m_engine, &GameEngine::chainsChanged, this, &HintEngine::cancel);
+        connect(m_engine, &GameEngine::turnEnded, this, &HintEngine::cancel);
+    }
+}
+
+bool HintEngine::isBusy() const
+{
+    return m_busy;
+}
+
+QFuture<HintEngine::Hint> HintEngine::findHint()
+{
+    cancel();
+
+    if (m_engine == nullptr
+        || m_engine->stage() != GameEngine::PlaceDotStage) {
+        return QFuture<Hint>();
+    }
+
+    const int rows = m_engine->rows();
+    const int columns = m_engine->columns();
+    QBitArray candidatePoints((rows + 1) * (columns + 1), false);
+    QVector<QPoint> candidates;
+    bool hasDots = false;
+
+    // placements away from every dot can neither capture nor threaten
+    for (const Dot *dot : m_engine->getDots()) {
+        if (!dot->isActive()) {
+            continue;
+        }
+
+        hasDots = true;
+
+        for (int dy = -CANDIDATE_DISTANCE; dy <= CANDIDATE_DISTANCE; ++dy) {
+            for (int dx = -CANDIDATE_DISTANCE; dx <= CANDIDATE_DISTANCE;
+                 ++dx) {
+                const int x = dot->x() + dx;
+                const int y = dot->y() + dy;
+
+                if (m_engine->canPlaceDot(x, y)
+                    && !candidatePoints.testBit(y * (columns + 1) + x)) {
+                    candidatePoints.setBit(y * (columns + 1) + x);
+                    candidates.append(QPoint(x, y));
+                }
+            }
+        }
+    }
+
+    if (!hasDots && m_engine->canPlaceDot(columns / 2, rows / 2)) {
+        candidates.append(QPoint(columns / 2, rows / 2));
+    }
+
+    if (candidates.isEmpty()) {
+        for (int y = 0; y <= rows; ++y) {
+            for (int x = 0; x <= columns; ++x) {
+                if (m_engine->canPlaceDot(x, y)) {
+                    candidates.append(QPoint(x, y));
+                }
+            }
+        }
+    }
+
+    if (candidates.isEmpty()) {
+        return QFuture<Hint>();
+    }
+
+    // the copy is shared by the workers, which only read it, and is deleted
+    // on this thread once the last of them is done
+    std::shared_ptr<GameEngine> copy(
+        new GameEngine(), [](GameEngine *engine) { engine->deleteLater(); });
+
+    copy->copyGame(*m_engine);
+
+    const std::shared_ptr<const GameEngine> position = copy;
+
+    const QFuture<Hint> future = QtConcurrent::mappedReduced(
+        candidates,
+        std::function<Hint(const QPoint &)>([position](const QPoint &point) {
+            return evaluate(*position, point);
+        }),
+        &HintEngine::keepBest);
+
+    m_pendingGeneration = m_generation;
+    m_watcher.setFuture(future);
+
+    setBusy(true);
+
+    return future;
+}
+
+void HintEngine::requestHint()
+{
+    findHint();
+}
+
+void HintEngine::cancel()
+{
+    ++m_generation;
+
+    m_watcher.cancel();
+
+    setBusy(false);
+}
+
+void HintEngine::setBusy(bool busy)
+{
+    if (busy == m_busy) {
+        return;
+    }
+
+    m_busy = busy;
+
+    emit busyChanged();
+}
+
+void HintEngine::finishHint()
+{
+    // discard the hints of searches that have since been cancelled
+    if (m_watcher.isCanceled() || m_pendingGeneration != m_generation) {
+        return;
+    }
+
+    const Hint hint = m_watcher.result();
+
+    setBusy(false);
+
+    if (hint.x >= 0) {
+        emit hintFound(hint.x, hint.y);
+    }
+}
+
+HintEngine::Hint HintEngine::evaluate(
+    const GameEngine &position,
+    const QPoint &point)
+{
+    GameEngine engine;
+
+    engine.copyGame(position);
+
+    const int player = engine.currentPlayer();
+    const int scoreBefore = engine.playerScores().at(player).toInt();
+    const int linesBefore = static_cast<int>(engine.getLines(player).size());
+
+    engine.placeDot(point.x(), point.y());
+    engine.connectAllDots();
+
+    int opponentThreats = 0;
+
+    for (int i = 0; i < engine.numPlayers(); ++i) {
+        if (i != player) {
+            opponentThreats += engine.threatenedPoints(i).count(true);
+        }
+    }
+
+    const int scoreGain =
+        engine.playerScores().at(player).toInt() - scoreBefore;
+    const int lineGain =
+        static_cast<int>(engine.getLines(player).size()) - linesBefore;
+    Hint hint;
+
+    hint.x = point.x();
+    hint.y = point.y();
+    hint.score = CAPTURE_WEIGHT * scoreGain + LINE_WEIGHT * lineGain
+        + THREAT_WEIGHT * engine.threatenedPoints(player).count(true)
+        - DEFENCE_WEIGHT * opponentThreats;
+
+    return hint;
+}
+
+void HintEngine::keepBest(HintEngine::Hint &best, const HintEngine::Hint &hint)
+{
+    // ties go to the first point in reading order, whatever order the
+    // candidates finish in
+    if (best.x < 0 || hint.score > best.score
+        || (hint.score == best.score
+            && (hint.y < best.y || (hint.y == best.y && hint.x < best.x)))) {
+        best = hint;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef HINTENGINE_H
+#define HINTENGINE_H
+
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QPoint>
+#include <limits>
+#include <memory>
+
+class GameEngine;
+
+/// Suggests where the current player could place their next dot.
+///
+/// Each candidate placement is tried out on a copy of the game on the global
+/// thread pool, so the GUI thread only pays for taking the copy. A candidate
+/// is scored by the dots it captures, the lines it finalizes and the points
+/// threatened afterwards by the player and by their opponents. The search is
+/// cancelled as soon as the game changes.
+class HintEngine : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(GameEngine *engine READ engine WRITE setEngine)
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+
+public:
+    struct Hint
+    {
+        int x = -1;
+        int y = -1;
+        int score = std::numeric_limits<int>::min();
+    };
+
+    explicit HintEngine(QObject *parent = nullptr);
+    ~HintEngine() override;
+
+    GameEngine *engine() const;
+    void setEngine(GameEngine *engine);
+
+    /// Checks if a hint is being searched for.
+    bool isBusy() const;
+
+    /// Starts searching for the best placement for the current player,
+    /// cancelling any previous search.
+    ///
+    /// \returns a future of the hint, or a cancelled future if no dot can be
+    /// placed. The hint is also given by hintFound().
+    QFuture<Hint> findHint();
+
+public slots:
+    void requestHint();
+    void cancel();
+
+signals:
+    void busyChanged();
+    void hintFound(int x, int y);
+
+private:
+    void setBusy(bool busy);
+    void finishHint();
+
+    static Hint evaluate(const GameEngine &position, const QPoint &point);
+    static void keepBest(Hint &best, const Hint &hint);
+
+    static const int CANDIDATE_DISTANCE = 2;
+    static const int CAPTURE_WEIGHT = 100;
+    static const int LINE_WEIGHT = 10;
+    static const int THREAT_WEIGHT = 4;
+    static const int DEFENCE_WEIGHT = 6;
+
+    GameEngine *m_engine;
+    QFutureWatcher<Hint> m_watcher;
+    bool m_busy;
+    int m_generation;
+    int m_pendingGeneration;
+};
+
+#endif // HINTENGINE_H
@@ -0,0 +1,67 @@
+#include "instrumentation.h"
+
+std::atomic<qint64> Instrumentation::s_values[CounterCount];
+
+Instrumentation::ScopedTimer::ScopedTimer(Counter counter, bool enabled)
+    : m_counter(counter)
+    , m_enabled(enabled)
+{
+    if (m_enabled) {
+        m_timer.start();
+    }
+}
+
+Instrumentation::ScopedTimer::~ScopedTimer()
+{
+    if (m_enabled) {
+        setValue(m_counter, m_timer.nsecsElapsed());
+    }
+}
+
+qint64 Instrumentation::value(Counter counter)
+{
+    return s_values[counter].load(std::memory_order_relaxed);
+}
+
+void Instrumentation::setValue(Counter counter, qint64 value)
+{
+    s_values[counter].store(value, std::memory_order_relaxed);
+}
+
+void Instrumentation::addValue(Counter counter, qint64 value)
+{
+    s_values[counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+const char *Instrumentation::name(Counter counter)
+{
+    static const char *const names[] = {"updatePaintNode",
+                                        "grid",
+                                        "overview",
+                                        "legal moves",
+                                        "threats",
+                                        "dots",
+                                        "lines",
+                                        "chains",
+                                        "provisional dot",
+                                        "provisional chain",
+                                        "dot tiles",
+                                        "line tiles",
+                                        "chain nodes",
+                                        "texture uploads",
+                                        "placeDot",
+                                        "connectDots",
+                                        "connectAllDots",
+                                        "endTurn"};
+
+    return names[counter];
+}
+
+bool Instrumentation::isEnabled()
+{
+#ifdef PAPERCHESS_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
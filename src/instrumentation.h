@@ -0,0 +1,85 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <QElapsedTimer>
+#include <atomic>
+
+/// Process-wide counters shown by the debug overlay.
+///
+/// The counters are recorded through the INSTRUMENT_* macros, which compile to
+/// nothing unless PAPERCHESS_INSTRUMENTATION is defined, as it is in debug
+/// builds. Recording is a relaxed atomic store, so it is safe from both the
+/// GUI and render threads.
+class Instrumentation
+{
+public:
+    enum Counter
+    {
+        PaintNodeTime,
+        GridNodeTime,
+        OverviewNodeTime,
+        LegalMoveNodeTime,
+        ThreatNodeTime,
+        DotContainerTime,
+        LineContainerTime,
+        ChainContainerTime,
+        ProvisionalDotContainerTime,
+        ProvisionalChainContainerTime,
+        DotTileCount,
+        LineTileCount,
+        ChainNodeCount,
+        TextureUploadCount,
+        PlaceDotTime,
+        ConnectDotsTime,
+        ConnectAllDotsTime,
+        EndTurnTime,
+        CounterCount
+    };
+
+    /// Measures the time until it goes out of scope, in nanoseconds, unless
+    /// it is disabled.
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Counter counter, bool enabled = true);
+        ~ScopedTimer();
+
+    private:
+        Counter m_counter;
+        bool m_enabled;
+        QElapsedTimer m_timer;
+    };
+
+    static qint64 value(Counter counter);
+    static void setValue(Counter counter, qint64 value);
+    static void addValue(Counter counter, qint64 value);
+
+    /// Gets a label for the counter to show in the overlay.
+    static const char *name(Counter counter);
+
+    /// Checks if the counters are recorded in this build.
+    static bool isEnabled();
+
+private:
+    static std::atomic<qint64> s_values[CounterCount];
+};
+
+#ifdef PAPERCHESS_INSTRUMENTATION
+#define INSTRUMENT_TIME(counter)                                               \
+    Instrumentation::ScopedTimer instrumentationTimer(                         \
+        Instrumentation::counter)
+#define INSTRUMENT_TIME_IF(counter, condition)                                 \
+    Instrumentation::ScopedTimer instrumentationTimer(                         \
+        Instrumentation::counter, condition)
+#define INSTRUMENT_SET(counter, value)                                         \
+    Instrumentation::setValue(Instrumentation::counter, value)
+#define INSTRUMENT_ADD(counter, value)                                         \
+    Instrumentation::addValue(Instrumentation::counter, value)
+#else
+#define INSTRUMENT_TIME(counter)
+#define INSTRUMENT_TIME_IF(counter, condition)
+#define INSTRUMENT_SET(counter, value)
+#define INSTRUMENT_ADD(counter, value)
+#endif
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,75 @@
+#include "linelistmodel.h"
+#include "line.h"
+
+LineListModel::LineListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int LineListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_lines.size();
+}
+
+QVariant LineListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_lines.size()) {
+        return QVariant();
+    }
+
+    const Entry &line = m_lines.at(index.row());
+
+    switch (role) {
+        case PlayerRole:
+            return line.player;
+        case X1Role:
+            return line.x1;
+        case Y1Role:
+            return line.y1;
+        case X2Role:
+            return line.x2;
+        case Y2Role:
+            return line.y2;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> LineListModel::roleNames() const
+{
+    QHash<int, QByteArray> names;
+
+    names[PlayerRole] = "player";
+    names[X1Role] = "x1";
+    names[Y1Role] = "y1";
+    names[X2Role] = "x2";
+    names[Y2Role] = "y2";
+
+    return names;
+}
+
+void LineListModel::appendLine(const Line &line)
+{
+    const Dot &endpoint1 = line.endpoint1();
+    const Dot &endpoint2 = line.endpoint2();
+    const int row = m_lines.size();
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_lines.append({endpoint1.player(),
+                    endpoint1.x(),
+                    endpoint1.y(),
+                    endpoint2.x(),
+                    endpoint2.y()});
+    endInsertRows();
+}
+
+void LineListModel::clear()
+{
+    if (m_lines.isEmpty()) {
+        return;
+    }
+
+    beginResetModel();
+    m_lines.clear();
+    endResetModel();
+}
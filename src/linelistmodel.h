@@ -0,0 +1,49 @@
+#ifndef LINELISTMODEL_H
+#define LINELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+
+class Line;
+
+/// List of the lines finalized in the current game, in the order they were
+/// finalized.
+class LineListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role
+    {
+        PlayerRole = Qt::UserRole + 1,
+        X1Role,
+        Y1Role,
+        X2Role,
+        Y2Role
+    };
+
+    explicit LineListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole)
+        const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void appendLine(const Line &line);
+
+    void clear();
+
+private:
+    struct Entry
+    {
+        int player;
+        int x1;
+        int y1;
+        int x2;
+        int y2;
+    };
+
+    QVector<Entry> m_lines;
+};
+
+#endif // LINELISTMODEL_H
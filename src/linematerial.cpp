@@ -0,0 +1,230 @@
+#include "linematerial.h"
+#include "shaderscale.h"
+#include <QLineF>
+#include <QOpenGLShaderProgram>
+#include <QVector4D>
+
+namespace
+{
+    class LineMaterialShader : public QSGMaterialShader
+    {
+    public:
+        LineMaterialShader();
+
+        char const *const *attributeNames() const override;
+        void updateState(
+            const RenderState &state,
+            QSGMaterial *newMaterial,
+            QSGMaterial *oldMaterial) override;
+
+    protected:
+        void initialize() override;
+
+    private:
+        int m_matrixId;
+        int m_opacityId;
+        int m_colorId;
+        int m_pixelSizeId;
+    };
+
+    LineMaterialShader::LineMaterialShader()
+        : m_matrixId(-1)
+        , m_opacityId(-1)
+        , m_colorId(-1)
+        , m_pixelSizeId(-1)
+    {
+        setShaderSourceFile(
+            QOpenGLShader::Vertex, QStringLiteral(":/shaders/line.vert"));
+        setShaderSourceFile(
+            QOpenGLShader::Fragment, QStringLiteral(":/shaders/line.frag"));
+    }
+
+    char const *const *LineMaterialShader::attributeNames() const
+    {
+        static const char *const names[] = {
+            "vertex", "offset", "segment", nullptr};
+
+        return names;
+    }
+
+    void LineMaterialShader::updateState(
+        const RenderState &state,
+        QSGMaterial *newMaterial,
+        QSGMaterial *oldMaterial)
+    {
+        QOpenGLShaderProgram *program = QSGMaterialShader::program();
+
+        if (state.isMatrixDirty()) {
+            program->setUniformValue(m_matrixId, state.combinedMatrix());
+            program->setUniformValue(
+                m_pixelSizeId, ShaderScale::pixelSize(state));
+        }
+
+        if (state.isOpacityDirty()) {
+            program->setUniformValue(m_opacityId, state.opacity());
+        }
+
+        const LineMaterial *material = static_cast<LineMaterial *>(newMaterial);
+
+        if (oldMaterial != nullptr && material->compare(oldMaterial) == 0) {
+            return;
+        }
+
+        const QColor color = material->color();
+
+        program->setUniformValue(
+            m_colorId,
+            QVector4D(
+                static_cast<float>(color.redF() * color.alphaF()),
+                static_cast<float>(color.greenF() * color.alphaF()),
+                static_cast<float>(color.blueF() * color.alphaF()),
+                static_cast<float>(color.alphaF())));
+    }
+
+    void LineMaterialShader::initialize()
+    {
+        QOpenGLShaderProgram *program = QSGMaterialShader::program();
+
+        m_matrixId = program->uniformLocation("qt_Matrix");
+        m_opacityId = program->uniformLocation("qt_Opacity");
+        m_colorId = program->uniformLocation("color");
+        m_pixelSizeId = program->uniformLocation("pixelSize");
+    }
+}
+
+void LineMaterial::Vertex::set(
+    float x,
+    float y,
+    float along,
+    float across,
+    float length,
+    float width)
+{
+    this->x = x;
+    this->y = y;
+    this->along = along;
+    this->across = across;
+    this->length = length;
+    this->width = width;
+}
+
+LineMaterial::LineMaterial()
+    : m_color(Qt::black)
+{
+    setFlag(Blending);
+}
+
+QSGMaterialType *LineMaterial::type() const
+{
+    static QSGMaterialType type;
+
+    return &type;
+}
+
+QSGMaterialShader *LineMaterial::createShader() const
+{
+    return new LineMaterialShader();
+}
+
+int LineMaterial::compare(const QSGMaterial *other) const
+{
+    const LineMaterial *material = static_cast<const LineMaterial *>(other);
+
+    if (m_color != material->m_color) {
+        return m_color.rgba() < material->m_color.rgba() ? -1 : 1;
+    }
+
+    return 0;
+}
+
+QColor LineMaterial::color() const
+{
+    return m_color;
+}
+
+void LineMaterial::setColor(const QColor &color)
+{
+    m_color = color;
+}
+
+const QSGGeometry::AttributeSet &LineMaterial::attributes()
+{
+    static const QSGGeometry::Attribute data[] = {
+        QSGGeometry::Attribute::create(0, 2, QSGGeometry::FloatType, true),
+        QSGGeometry::Attribute::create(1, 2, QSGGeometry::FloatType),
+        QSGGeometry::Attribute::create(2, 2, QSGGeometry::FloatType)};
+    static const QSGGeometry::AttributeSet attributes = {
+        3, sizeof(Vertex), data};
+
+    return attributes;
+}
+
+void LineMaterial::appendSegment(
+    Vertex *&vertices,
+    const QPointF &point1,
+    const QPointF &point2,
+    qreal width)
+{
+    const QLineF line(point1, point2);
+    const qreal length = line.length();
+
+    // leave room for the rounded ends and the antialiasing, which is a unit of
+    // the geometry wide at the scale the board is usually drawn at
+    const qreal reach = width * 0.5 + 1;
+    const QPointF direction = qFuzzyIsNull(length)
+        ? QPointF(reach, 0)
+        : (point2 - point1) * (reach / length);
+    const QPointF normal(-direction.y(), direction.x());
+    const QPointF corners[] = {point1 - direction - normal,
+                               point1 - direction + normal,
+                               point2 + direction - normal,
+                               point2 + direction + normal};
+    const float along1 = static_cast<float>(-reach);
+    const float along2 = static_cast<float>(length + reach);
+    const float across = static_cast<float>(reach);
+    const float segmentLength = static_cast<float>(length);
+    const float lineWidth = static_cast<float>(width);
+
+    (vertices++)->set(
+        static_cast<float>(corners[0].x()),
+        static_cast<float>(corners[0].y()),
+        along1,
+        -across,
+        segmentLength,
+        lineWidth);
+    (vertices++)->set(
+        static_cast<float>(corners[1].x()),
+        static_cast<float>(corners[1].y()),
+        along1,
+        across,
+        segmentLength,
+        lineWidth);
+    (vertices++)->set(
+        static_cast<float>(corners[2].x()),
+        static_cast<float>(corners[2].y()),
+        along2,
+        -across,
+        segmentLength,
+        lineWidth);
+    (vertices++)->set(
+        static_cast<float>(corners[3].x()),
+        static_cast<float>(corners[3].y()),
+        along2,
+        across,
+        segmentLength,
+        lineWidth);
+}
+
+void LineMaterial::appendSegmentIndices(quint16 *&indices, int firstVertex)
+{
+    for (int i : {0, 1, 2, 2, 1, 3}) {
+        *(indices++) = static_cast<quint16>(firstVertex + i);
+    }
+}
+
+void LineMaterial::appendSegmentIndices(quint32 *&indices, int firstVertex)
+{
+    for (int i : {0, 1, 2, 2, 1, 3}) {
+        *(indices++) = static_cast<quint32>(firstVertex + i);
+    }
+}
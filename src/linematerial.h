@@ -0,0 +1,79 @@
+#ifndef LINEMATERIAL_H
+#define LINEMATERIAL_H
+
+#include <QColor>
+#include <QSGGeometry>
+#include <QSGMaterial>
+
+class QPointF;
+
+/// Material which draws thick antialiased lines as triangles.
+///
+/// Each segment is a quad reaching past both endpoints by half the line width.
+/// The fragment shader measures the distance from the segment, which rounds
+/// off the ends, so segments sharing an endpoint meet in a round join.
+///
+/// The width is part of the vertices rather than the material, so lines of
+/// the same colour share a material whatever the size of their board.
+///
+/// The shader only runs on the OpenGL renderer; GameBoard draws the segments
+/// as rotated rectangles of the material's colour on the others.
+class LineMaterial : public QSGMaterial
+{
+public:
+    struct Vertex
+    {
+        float x;
+        float y;
+
+        /// The position along the segment from its first endpoint, in the
+        /// units of the geometry.
+        float along;
+
+        /// The position across the segment from its centre line, in the units
+        /// of the geometry.
+        float across;
+
+        float length;
+        float width;
+
+        void set(
+            float x,
+            float y,
+            float along,
+            float across,
+            float length,
+            float width);
+    };
+
+    static const int SEGMENT_VERTEX_COUNT = 4;
+    static const int SEGMENT_INDEX_COUNT = 6;
+
+    LineMaterial();
+
+    QSGMaterialType *type() const override;
+    QSGMaterialShader *createShader() const override;
+    int compare(const QSGMaterial *other) const override;
+
+    QColor color() const;
+    void setColor(const QColor &color);
+
+    /// Gets the vertex layout used with this material.
+    static const QSGGeometry::AttributeSet &attributes();
+
+    /// Appends the vertices of a segment drawn with the specified width.
+    static void appendSegment(
+        Vertex *&vertices,
+        const QPointF &point1,
+        const QPointF &point2,
+        qreal width);
+
+    /// Appends the indices of the segment starting at the specified vertex.
+    static void appendSegmentIndices(quint16 *&indices, int firstVertex);
+    static void appendSegmentIndices(quint32 *&indices, int firstVertex);
+
+private:
+    QColor m_color;
+};
+
+#endif // LINEMATERIAL_H
@@ -1,9 +1,49 @@
+#include "aiplayer.h"
+#include "debugmonitor.h"
+#include "endgamesolver.h"
 #include "gameboard.h"
 #include "gameengine.h"
+#include "hintengine.h"
+#include "movelog.h"
+#include "startupprofile.h"
 #include "stroke.h"
+#include "tracing.h"
+#include <QFontDatabase>
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
+
+namespace
+{
+    /// Registers the fonts used by the pages once, instead of each page
+    /// loading its own copy.
+    ///
+    /// \returns a map from the role of each font to its family name.
+    QVariantMap registerFonts()
+    {
+        static const char *const fonts[][2] = {
+            {"print", ":/fonts/CantataOne-Regular.ttf"},
+            {"handwriting", ":/fonts/CoveredByYourGrace.ttf"},
+            {"bold", ":/fonts/Nunito-Bold.ttf"},
+            {"regular", ":/fonts/OpenSans-Regular.ttf"}};
+        QVariantMap families;
+
+        for (const auto &font : fonts) {
+            const int id = QFontDatabase::addApplicationFont(font[1]);
+            const QStringList names =
+                QFontDatabase::applicationFontFamilies(id);
+
+            if (names.isEmpty()) {
+                qWarning("Cannot load the font %s", font[1]);
+            }
+
+            families.insert(font[0], names.value(0));
+        }
+
+        return families;
+    }
+}
 
 int main(int argc, char *argv[])
 {
@@ -11,19 +51,64 @@ int main(int argc, char *argv[])
 
     QGuiApplication app(argc, argv);
 
+    Tracing::initialize();
+
+    StartupProfile startupProfile;
+
+    startupProfile.mark(QStringLiteral("application created"));
+
     qmlRegisterType<GameEngine>("PaperChess", 1, 0, "GameEngine");
     qmlRegisterType<GameBoard>("PaperChess", 1, 0, "GameBoard");
     qmlRegisterType<Stroke>("PaperChess", 1, 0, "Stroke");
+    qmlRegisterType<DebugMonitor>("PaperChess", 1, 0, "DebugMonitor");
+    qmlRegisterType<HintEngine>("PaperChess", 1, 0, "HintEngine");
+    qmlRegisterType<AiPlayer>("PaperChess", 1, 0, "AiPlayer");
+    qmlRegisterType<EndgameSolver>("PaperChess", 1, 0, "EndgameSolver");
 
     QQmlApplicationEngine engine;
 
     GameEngine gameEngine;
+
+    const QString moveLogPath =
+        QString::fromLocal8Bit(qgetenv("PAPERCHESS_MOVE_LOG"));
+
+    if (!moveLogPath.isEmpty() && !gameEngine.moveLog()->setFile(moveLogPath)) {
+        qWarning("Cannot write the move log to %s", qPrintable(moveLogPath));
+    }
+
+    // plays no one's turns until a game against the computer is started
+    AiPlayer aiPlayer;
+
+    aiPlayer.setEngine(&gameEngine);
+
+    EndgameSolver endgameSolver;
+
+    endgameSolver.setEngine(&gameEngine);
+
+    startupProfile.begin(QStringLiteral("fonts"));
+
+    const QVariantMap fontFamilies = registerFonts();
+
+    startupProfile.end(QStringLiteral("fonts"));
+
     engine.rootContext()->setContextProperty("gameEngine", &gameEngine);
+    engine.rootContext()->setContextProperty("aiPlayer", &aiPlayer);
+    engine.rootContext()->setContextProperty(
+        "endgameSolver", &endgameSolver);
+    engine.rootContext()->setContextProperty("fontFamilies", fontFamilies);
+    engine.rootContext()->setContextProperty(
+        "startupProfile", &startupProfile);
+
+    startupProfile.begin(QStringLiteral("main.qml"));
 
     engine.load(QUrl(QStringLiteral("qrc:/qml/main.qml")));
     if (engine.rootObjects().isEmpty()) {
         return -1;
     }
 
+    startupProfile.end(QStringLiteral("main.qml"));
+    startupProfile.watchFirstFrame(
+        qobject_cast<QQuickWindow *>(engine.rootObjects().first()));
+
     return app.exec();
 }
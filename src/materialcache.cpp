@@ -0,0 +1,101 @@
+#include "materialcache.h"
+#include "dotmaterial.h"
+#include "linematerial.h"
+#include <QMutexLocker>
+#include <QQuickWindow>
+
+DotMaterial *MaterialCache::dotMaterial(
+    QQuickWindow *window,
+    QSGTexture *texture)
+{
+    MaterialCache *cache = instance();
+    QMutexLocker locker(&cache->m_mutex);
+    WindowMaterials &materials = cache->windowMaterials(window);
+    DotMaterial *&material = materials.dotMaterials[texture];
+
+    if (material == nullptr) {
+        material = new DotMaterial();
+        material->setTexture(texture);
+    }
+
+    ++materials.dotMaterialRefCounts[material];
+
+    return material;
+}
+
+void MaterialCache::releaseDotMaterial(
+    QQuickWindow *window,
+    DotMaterial *material)
+{
+    MaterialCache *cache = instance();
+    QMutexLocker locker(&cache->m_mutex);
+
+    // the materials may already be gone along with the scene graph
+    if (!cache->m_materials.contains(window)) {
+        return;
+    }
+
+    WindowMaterials &materials = cache->m_materials[window];
+    const auto it = materials.dotMaterialRefCounts.find(material);
+
+    if (it == materials.dotMaterialRefCounts.end() || --*it > 0) {
+        return;
+    }
+
+    materials.dotMaterialRefCounts.erase(it);
+    materials.dotMaterials.remove(material->texture());
+
+    delete material;
+}
+
+LineMaterial *MaterialCache::lineMaterial(
+    QQuickWindow *window,
+    const QColor &color)
+{
+    MaterialCache *cache = instance();
+    QMutexLocker locker(&cache->m_mutex);
+    LineMaterial *&material =
+        cache->windowMaterials(window).lineMaterials[color.rgba()];
+
+    if (material == nullptr) {
+        material = new LineMaterial();
+        material->setColor(color);
+    }
+
+    return material;
+}
+
+MaterialCache::MaterialCache()
+{
+}
+
+MaterialCache *MaterialCache::instance()
+{
+    static MaterialCache cache;
+
+    return &cache;
+}
+
+MaterialCache::WindowMaterials &MaterialCache::windowMaterials(
+    QQuickWindow *window)
+{
+    if (!m_materials.contains(window)) {
+        QObject::connect(
+            window,
+            &QQuickWindow::sceneGraphInvalidated,
+            window,
+            [this, window] { releaseMaterials(window); },
+            Qt::DirectConnection);
+    }
+
+    return m_materials[window];
+}
+
+void MaterialCache::releaseMaterials(QQuickWindow *window)
+{
+    QMutexLocker locker(&m_mutex);
+    const WindowMaterials materials = m_materials.take(window);
+
+    qDeleteAll(materials.dotMaterials);
+    qDeleteAll(materials.lineMaterials);
+}
@@ -0,0 +1,71 @@
+#ifndef MATERIALCACHE_H
+#define MATERIALCACHE_H
+
+#include <QColor>
+#include <QHash>
+#include <QMutex>
+
+class DotMaterial;
+class LineMaterial;
+class QQuickWindow;
+class QSGTexture;
+
+/// Cache of the materials of the boards in each window.
+///
+/// Boards drawing with equal materials get the same instance, so any number
+/// of boards costs one material per dot texture and line colour, and the
+/// renderer can batch their nodes together. The materials must therefore not
+/// be modified once they are handed out.
+class MaterialCache
+{
+public:
+    /// Gets the material drawing dots with the specified texture.
+    ///
+    /// Must be called on the window's render thread. The material is owned by
+    /// the cache, and each call holds a reference to it until it is given back
+    /// with releaseDotMaterial(). It is deleted once the last reference is
+    /// given back, or when the window's scene graph is invalidated.
+    ///
+    /// \returns the material.
+    static DotMaterial *dotMaterial(QQuickWindow *window, QSGTexture *texture);
+
+    /// Gives back a reference to a material returned by dotMaterial(), so
+    /// that the materials of superseded textures do not outlive their last
+    /// user.
+    static void releaseDotMaterial(
+        QQuickWindow *window,
+        DotMaterial *material);
+
+    /// Gets the material drawing lines with the specified colour.
+    ///
+    /// Must be called on the window's render thread. The material is owned by
+    /// the cache and deleted when the window's scene graph is invalidated.
+    ///
+    /// \returns the material.
+    static LineMaterial *lineMaterial(
+        QQuickWindow *window,
+        const QColor &color);
+
+private:
+    struct WindowMaterials
+    {
+        QHash<QSGTexture *, DotMaterial *> dotMaterials;
+        QHash<DotMaterial *, int> dotMaterialRefCounts;
+        QHash<QRgb, LineMaterial *> lineMaterials;
+    };
+
+    MaterialCache();
+
+    static MaterialCache *instance();
+
+    /// Gets the materials of the window, arranging for them to be released
+    /// along with its scene graph. The mutex must be locked.
+    WindowMaterials &windowMaterials(QQuickWindow *window);
+
+    void releaseMaterials(QQuickWindow *window);
+
+    QMutex m_mutex;
+    QHash<QQuickWindow *, WindowMaterials> m_materials;
+};
+
+#endif // MATERIALCACHE_H
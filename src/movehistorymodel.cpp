@@ -0,0 +1,72 @@
+#include "movehistorymodel.h"
+
+MoveHistoryModel::MoveHistoryModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int MoveHistoryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_moves.size();
+}
+
+QVariant MoveHistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_moves.size()) {
+        return QVariant();
+    }
+
+    const Entry &move = m_moves.at(index.row());
+
+    switch (role) {
+        case TypeRole:
+            return static_cast<int>(move.type);
+        case PlayerRole:
+            return move.player;
+        case X1Role:
+            return move.x1;
+        case Y1Role:
+            return move.y1;
+        case X2Role:
+            return move.x2;
+        case Y2Role:
+            return move.y2;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> MoveHistoryModel::roleNames() const
+{
+    QHash<int, QByteArray> names;
+
+    names[TypeRole] = "type";
+    names[PlayerRole] = "player";
+    names[X1Role] = "x1";
+    names[Y1Role] = "y1";
+    names[X2Role] = "x2";
+    names[Y2Role] = "y2";
+
+    return names;
+}
+
+void MoveHistoryModel::append(
+    MoveLog::EventType type, int player, int x1, int y1, int x2, int y2)
+{
+    const int row = m_moves.size();
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_moves.append({type, player, x1, y1, x2, y2});
+    endInsertRows();
+}
+
+void MoveHistoryModel::clear()
+{
+    if (m_moves.isEmpty()) {
+        return;
+    }
+
+    beginResetModel();
+    m_moves.clear();
+    endResetModel();
+}
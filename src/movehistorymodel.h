@@ -0,0 +1,58 @@
+#ifndef MOVEHISTORYMODEL_H
+#define MOVEHISTORYMODEL_H
+
+#include "movelog.h"
+#include <QAbstractListModel>
+#include <QVector>
+
+/// List of the moves made in the current game, oldest first.
+///
+/// The type role holds a MoveLog::EventType; the coordinates which do not
+/// apply to a move are -1.
+class MoveHistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role
+    {
+        TypeRole = Qt::UserRole + 1,
+        PlayerRole,
+        X1Role,
+        Y1Role,
+        X2Role,
+        Y2Role
+    };
+
+    explicit MoveHistoryModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole)
+        const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void append(
+        MoveLog::EventType type,
+        int player,
+        int x1 = -1,
+        int y1 = -1,
+        int x2 = -1,
+        int y2 = -1);
+
+    void clear();
+
+private:
+    struct Entry
+    {
+        MoveLog::EventType type;
+        int player;
+        int x1;
+        int y1;
+        int x2;
+        int y2;
+    };
+
+    QVector<Entry> m_moves;
+};
+
+#endif // MOVEHISTORYMODEL_H
@@ -0,0 +1,138 @@
+#include "movelog.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QtConcurrent>
+
+MoveLog::MoveLog(QObject *parent)
+    : QObject(parent)
+    , m_records(CAPACITY)
+    , m_head(0)
+    , m_tail(0)
+    , m_droppedCount(0)
+    , m_enabled(false)
+{
+    m_clock.start();
+    m_drainTimer.setInterval(DRAIN_INTERVAL);
+
+    connect(&m_drainTimer, &QTimer::timeout, this, &MoveLog::scheduleDrain);
+}
+
+MoveLog::~MoveLog()
+{
+    flush();
+}
+
+void MoveLog::append(
+    MoveLog::EventType type,
+    int player,
+    int x1,
+    int y1,
+    int x2,
+    int y2)
+{
+    if (!m_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    const int head = m_head.load(std::memory_order_relaxed);
+    const int next = (head + 1) % CAPACITY;
+
+    if (next == m_tail.load(std::memory_order_acquire)) {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+
+        return;
+    }
+
+    m_records[head] = {m_clock.nsecsElapsed(),
+                       type,
+                       static_cast<qint8>(player),
+                       static_cast<qint16>(x1),
+                       static_cast<qint16>(y1),
+                       static_cast<qint16>(x2),
+                       static_cast<qint16>(y2)};
+    m_head.store(next, std::memory_order_release);
+}
+
+bool MoveLog::setFile(const QString &path)
+{
+    QMutexLocker locker(&m_sinkMutex);
+
+    m_file.close();
+    m_file.setFileName(path);
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    const qint64 createdAt = QDateTime::currentMSecsSinceEpoch()
+        - m_clock.nsecsElapsed() / 1000000;
+    QDataStream stream(&m_file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("PCML", 4);
+    stream << VERSION << createdAt;
+
+    m_enabled.store(true);
+    m_drainTimer.start();
+
+    return true;
+}
+
+void MoveLog::setCallback(const MoveLog::Callback &callback)
+{
+    QMutexLocker locker(&m_sinkMutex);
+
+    m_callback = callback;
+
+    m_enabled.store(true);
+    m_drainTimer.start();
+}
+
+int MoveLog::droppedCount() const
+{
+    return m_droppedCount.load(std::memory_order_relaxed);
+}
+
+void MoveLog::flush()
+{
+    m_drainFuture.waitForFinished();
+
+    drain();
+}
+
+void MoveLog::scheduleDrain()
+{
+    if (m_drainFuture.isRunning()
+        || m_tail.load(std::memory_order_relaxed)
+            == m_head.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    m_drainFuture = QtConcurrent::run(this, &MoveLog::drain);
+}
+
+void MoveLog::drain()
+{
+    QMutexLocker locker(&m_sinkMutex);
+    QDataStream stream(&m_file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    const int head = m_head.load(std::memory_order_acquire);
+    int tail = m_tail.load(std::memory_order_relaxed);
+
+    for (; tail != head; tail = (tail + 1) % CAPACITY) {
+        const Record &record = m_records[tail];
+
+        if (m_file.isOpen()) {
+            stream << record.timestamp << static_cast<quint8>(record.type)
+                   << record.player << record.x1 << record.y1 << record.x2
+                   << record.y2;
+        }
+
+        if (m_callback) {
+            m_callback(record);
+        }
+    }
+
+    m_tail.store(tail, std::memory_order_release);
+    m_file.flush();
+}
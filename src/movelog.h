@@ -0,0 +1,102 @@
+#ifndef MOVELOG_H
+#define MOVELOG_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/// Structured log of the moves made in a game.
+///
+/// Appending a record only copies it into a ring buffer, which is drained on a
+/// worker thread into a binary file and/or a callback. Records are dropped,
+/// and counted, if the buffer fills up faster than it is drained.
+///
+/// Nothing is recorded until a file or callback is set. A single thread,
+/// normally that of the engine, may append.
+class MoveLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum EventType : quint8
+    {
+        /// The board size is given as (x1, y1) = (columns, rows).
+        NewGameEvent,
+        PlaceDotEvent,
+        ConnectDotsEvent,
+        EndTurnEvent
+    };
+
+    struct Record
+    {
+        /// Nanoseconds since the log was created.
+        qint64 timestamp;
+        EventType type;
+        qint8 player;
+        qint16 x1;
+        qint16 y1;
+        qint16 x2;
+        qint16 y2;
+    };
+
+    using Callback = std::function<void(const Record &record)>;
+
+    explicit MoveLog(QObject *parent = nullptr);
+    ~MoveLog() override;
+
+    void append(
+        EventType type,
+        int player,
+        int x1 = -1,
+        int y1 = -1,
+        int x2 = -1,
+        int y2 = -1);
+
+    /// Writes the records to the specified file, replacing its contents.
+    ///
+    /// The file starts with the magic "PCML", a version and the creation time
+    /// of the log in milliseconds since the epoch, followed by the fields of
+    /// each record in order, all little-endian.
+    ///
+    /// \returns true if the file was opened, false otherwise.
+    bool setFile(const QString &path);
+
+    /// Sets a function to be called for each record, on the worker thread.
+    void setCallback(const Callback &callback);
+
+    /// Gets the number of records dropped because the buffer was full.
+    int droppedCount() const;
+
+    /// Drains the buffer and waits for the records to be written.
+    void flush();
+
+private:
+    void scheduleDrain();
+    void drain();
+
+    static const int CAPACITY = 4096;
+    static const int DRAIN_INTERVAL = 250;
+    static const quint32 VERSION = 1;
+
+    std::vector<Record> m_records;
+    std::atomic<int> m_head;
+    std::atomic<int> m_tail;
+    std::atomic<int> m_droppedCount;
+    std::atomic<bool> m_enabled;
+    QElapsedTimer m_clock;
+    QTimer m_drainTimer;
+    QFuture<void> m_drainFuture;
+
+    // the sinks are only used by the worker draining the buffer
+    QMutex m_sinkMutex;
+    QFile m_file;
+    Callback m_callback;
+};
+
+#endif // MOVELOG_H
@@ -0,0 +1,66 @@
+#include "playerlistmodel.h"
+
+PlayerListModel::PlayerListModel(int numPlayers, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_players(numPlayers, {QString(), 0})
+{
+}
+
+int PlayerListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_players.size();
+}
+
+QVariant PlayerListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_players.size()) {
+        return QVariant();
+    }
+
+    const Entry &player = m_players.at(index.row());
+
+    switch (role) {
+        case NameRole:
+            return player.name;
+        case ScoreRole:
+            return player.score;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> PlayerListModel::roleNames() const
+{
+    QHash<int, QByteArray> names;
+
+    names[NameRole] = "name";
+    names[ScoreRole] = "score";
+
+    return names;
+}
+
+void PlayerListModel::setName(int player, const QString &name)
+{
+    if (m_players.at(player).name == name) {
+        return;
+    }
+
+    m_players[player].name = name;
+
+    const QModelIndex changed = index(player);
+
+    emit dataChanged(changed, changed, {NameRole});
+}
+
+void PlayerListModel::setScore(int player, int score)
+{
+    if (m_players.at(player).score == score) {
+        return;
+    }
+
+    m_players[player].score = score;
+
+    const QModelIndex changed = index(player);
+
+    emit dataChanged(changed, changed, {ScoreRole});
+}
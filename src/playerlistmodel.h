@@ -0,0 +1,42 @@
+#ifndef PLAYERLISTMODEL_H
+#define PLAYERLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+
+/// List of the players with their names and scores, one row per player.
+///
+/// Changing a name or score only signals the role that changed for the row
+/// of that player.
+class PlayerListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role
+    {
+        NameRole = Qt::UserRole + 1,
+        ScoreRole
+    };
+
+    explicit PlayerListModel(int numPlayers, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole)
+        const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void setName(int player, const QString &name);
+    void setScore(int player, int score);
+
+private:
+    struct Entry
+    {
+        QString name;
+        int score;
+    };
+
+    QVector<Entry> m_players;
+};
+
+#endif // PLAYERLISTMODEL_H
@@ -0,0 +1,375 @@
+#include "proofsearch.h"
+#include "dot.h"
+#include "gameengine.h"
+#include <algorithm>
+#include <cstdlib>
+
+ProofSearch::ProofSearch(int tableSize)
+    : m_table(tableSize, Entry())
+    , m_attacker(-1)
+    , m_target(-1, -1)
+    , m_nodeCount(0)
+    , m_nodeBudget(0)
+{
+}
+
+ProofSearch::Result ProofSearch::search(
+    const GameEngine &position,
+    const QPoint &target,
+    int turns,
+    int nodeBudget,
+    const std::function<bool()> &stopped)
+{
+    m_line.clear();
+    m_attacker = position.currentPlayer();
+    m_target = target;
+    m_nodeCount = 0;
+    m_nodeBudget = nodeBudget;
+    m_stopped = stopped;
+
+    // the numbers are only valid for this target and attacker
+    std::fill(m_table.begin(), m_table.end(), Entry());
+
+    const Dot *dot = position.getDotAt(target.x(), target.y());
+
+    if (dot == nullptr || !dot->isActive() || dot->player() == m_attacker
+        || position.stage() != GameEngine::PlaceDotStage || turns <= 0) {
+        return DisprovenResult;
+    }
+
+    searchNode(position, 0, turns, INFINITE_NUMBER, INFINITE_NUMBER);
+
+    quint32 proof;
+    quint32 disproof;
+    quint32 work;
+
+    if (!lookUp(tableKey(position, turns), proof, disproof, work)) {
+        return UnknownResult;
+    }
+
+    if (proof == 0) {
+        readLine(position, turns);
+
+        return ProvenResult;
+    }
+
+    return disproof == 0 ? DisprovenResult : UnknownResult;
+}
+
+const std::vector<QPoint> &ProofSearch::line() const
+{
+    return m_line;
+}
+
+int ProofSearch::nodeCount() const
+{
+    return m_nodeCount;
+}
+
+void ProofSearch::searchNode(
+    const GameEngine &position,
+    int ply,
+    int turnsLeft,
+    quint32 proofThreshold,
+    quint32 disproofThreshold)
+{
+    // Implementation note: Multiple iterative deepening as in df-pn. The
+    // node stays on the stack, with its children, for as long as its numbers
+    // are below the thresholds, and the most proving child is searched with
+    // thresholds that send the search back here once a sibling would be
+    // cheaper.
+
+    const int startCount = m_nodeCount;
+    const bool attacking = position.currentPlayer() == m_attacker;
+    const quint64 key = tableKey(position, turnsLeft);
+    GameEngine &childPosition = positionAt(ply);
+    std::vector<Child> children =
+        expand(position, turnsLeft, childPosition);
+
+    while (true) {
+        quint32 proof = attacking ? INFINITE_NUMBER : 0;
+        quint32 disproof = attacking ? 0 : INFINITE_NUMBER;
+        Child *best = nullptr;
+        quint32 secondBest = INFINITE_NUMBER;
+
+        for (Child &child : children) {
+            readChild(child);
+
+            // the attacker needs one proven move and the others need one
+            // disproven reply, so the roles of the numbers swap
+            const quint32 selected = attacking ? child.proof : child.disproof;
+            const quint32 summed = attacking ? child.disproof : child.proof;
+            quint32 &minimum = attacking ? proof : disproof;
+            quint32 &sum = attacking ? disproof : proof;
+
+            minimum = std::min(minimum, selected);
+            sum = std::min(sum + summed, INFINITE_NUMBER);
+
+            if (best == nullptr
+                || selected < (attacking ? best->proof : best->disproof)) {
+                if (best != nullptr) {
+                    secondBest = attacking ? best->proof : best->disproof;
+                }
+
+                best = &child;
+            } else {
+                secondBest = std::min(secondBest, selected);
+            }
+        }
+
+        store(
+            key,
+            proof,
+            disproof,
+            static_cast<quint32>(m_nodeCount - startCount));
+
+        if (proof >= proofThreshold || disproof >= disproofThreshold
+            || m_nodeCount >= m_nodeBudget || m_stopped()) {
+            return;
+        }
+
+        // the children are kept as keys, so the chosen one is made again
+        childPosition.copyGame(position);
+        makeMove(childPosition, best->move);
+
+        if (attacking) {
+            searchNode(
+                childPosition,
+                ply + 1,
+                best->turnsLeft,
+                std::min(proofThreshold, secondBest + 1),
+                disproofThreshold - disproof + best->disproof);
+        } else {
+            searchNode(
+                childPosition,
+                ply + 1,
+                best->turnsLeft,
+                proofThreshold - proof + best->proof,
+                std::min(disproofThreshold, secondBest + 1));
+        }
+    }
+}
+
+std::vector<ProofSearch::Child> ProofSearch::expand(
+    const GameEngine &position,
+    int turnsLeft,
+    GameEngine &scratch)
+{
+    const bool attacking = position.currentPlayer() == m_attacker;
+    std::vector<QPoint> moves = findMoves(position, turnsLeft);
+    std::vector<Child> children;
+
+    // with nowhere to place a dot the turn is passed, which can prove nothing
+    if (moves.empty()) {
+        moves.push_back(QPoint(-1, -1));
+    }
+
+    for (const QPoint &move : moves) {
+        Child child;
+
+        scratch.copyGame(position);
+        makeMove(scratch, move);
+
+        child.move = move;
+        child.turnsLeft = attacking ? turnsLeft - 1 : turnsLeft;
+        child.key = tableKey(scratch, child.turnsLeft);
+        child.terminal = isTerminal(
+            scratch, child.turnsLeft, child.proof, child.disproof);
+
+        children.push_back(child);
+
+        ++m_nodeCount;
+    }
+
+    return children;
+}
+
+std::vector<QPoint> ProofSearch::findMoves(
+    const GameEngine &position,
+    int turnsLeft) const
+{
+    // a wall around the target is at most a placement beyond the points the
+    // attacker can still reach
+    const int reach = turnsLeft + 1;
+    const bool attacking = position.currentPlayer() == m_attacker;
+    std::vector<QPoint> moves;
+
+    for (int y = m_target.y() - reach; y <= m_target.y() + reach; ++y) {
+        for (int x = m_target.x() - reach; x <= m_target.x() + reach; ++x) {
+            if (position.canPlaceDot(x, y)) {
+                moves.push_back(QPoint(x, y));
+            }
+        }
+    }
+
+    if (attacking) {
+        return moves;
+    }
+
+    for (int y = 0; y <= position.rows(); ++y) {
+        for (int x = 0; x <= position.columns(); ++x) {
+            if (std::abs(x - m_target.x()) > reach
+                || std::abs(y - m_target.y()) > reach) {
+                if (position.canPlaceDot(x, y)) {
+                    moves.push_back(QPoint(x, y));
+
+                    return moves;
+                }
+            }
+        }
+    }
+
+    return moves;
+}
+
+bool ProofSearch::isTerminal(
+    const GameEngine &position,
+    int turnsLeft,
+    quint32 &proof,
+    quint32 &disproof) const
+{
+    const Dot *dot = position.getDotAt(m_target.x(), m_target.y());
+
+    if (dot == nullptr || !dot->isActive()) {
+        proof = 0;
+        disproof = INFINITE_NUMBER;
+
+        return true;
+    }
+
+    if (turnsLeft <= 0 || position.stage() == GameEngine::EndStage) {
+        proof = INFINITE_NUMBER;
+        disproof = 0;
+
+        return true;
+    }
+
+    return false;
+}
+
+void ProofSearch::readChild(Child &child) const
+{
+    if (child.terminal) {
+        return;
+    }
+
+    quint32 work;
+
+    if (!lookUp(child.key, child.proof, child.disproof, work)) {
+        child.proof = 1;
+        child.disproof = 1;
+    }
+}
+
+bool ProofSearch::lookUp(
+    quint64 key,
+    quint32 &proof,
+    quint32 &disproof,
+    quint32 &work) const
+{
+    const Entry &entry = m_table[key % m_table.size()];
+
+    if (entry.key != key) {
+        return false;
+    }
+
+    proof = entry.proof;
+    disproof = entry.disproof;
+    work = entry.work;
+
+    return true;
+}
+
+void ProofSearch::store(
+    quint64 key,
+    quint32 proof,
+    quint32 disproof,
+    quint32 work)
+{
+    Entry &entry = m_table[key % m_table.size()];
+
+    // the numbers that took the most work to find are the dearest to lose
+    if (entry.key == key || entry.work <= work) {
+        entry = {key, proof, disproof, work};
+    }
+}
+
+void ProofSearch::readLine(const GameEngine &position, int turns)
+{
+    GameEngine line;
+    int turnsLeft = turns;
+
+    line.copyGame(position);
+
+    while (true) {
+        const bool attacking = line.currentPlayer() == m_attacker;
+        Child *next = nullptr;
+        quint32 nextWork = 0;
+        std::vector<Child> children =
+            expand(line, turnsLeft, positionAt(0));
+
+        // the attacker follows a proven move, and the others the reply that
+        // took the longest to prove wrong
+        for (Child &child : children) {
+            quint32 work = 0;
+
+            if (!child.terminal
+                && !lookUp(child.key, child.proof, child.disproof, work)) {
+                continue;
+            }
+
+            if (child.proof != 0) {
+                continue;
+            }
+
+            if (attacking) {
+                next = &child;
+
+                break;
+            }
+
+            if (next == nullptr || work > nextWork) {
+                next = &child;
+                nextWork = work;
+            }
+        }
+
+        if (next == nullptr) {
+            return;
+        }
+
+        m_line.push_back(next->move);
+
+        if (next->terminal) {
+            return;
+        }
+
+        makeMove(line, next->move);
+        turnsLeft = next->turnsLeft;
+    }
+}
+
+GameEngine &ProofSearch::positionAt(int ply)
+{
+    while (static_cast<int>(m_positions.size()) <= ply) {
+        m_positions.emplace_back(new GameEngine());
+    }
+
+    return *m_positions[ply];
+}
+
+quint64 ProofSearch::tableKey(const GameEngine &position, int turnsLeft)
+{
+    // the position key leaves out the turns left to the attacker
+    return position.positionKey()
+        ^ static_cast<quint64>(turnsLeft) * Q_UINT64_C(0x9e3779b97f4a7c15);
+}
+
+void ProofSearch::makeMove(GameEngine &engine, const QPoint &move)
+{
+    if (engine.placeDot(move.x(), move.y())) {
+        engine.connectAllDots();
+    }
+
+    engine.endTurn();
+}
@@ -0,0 +1,131 @@
+#ifndef PROOFSEARCH_H
+#define PROOFSEARCH_H
+
+#include <QPoint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class GameEngine;
+
+/// Answers whether the player to move can force the capture of a dot within
+/// a number of their turns, whatever the other players do.
+///
+/// The search is a depth-first proof-number search: it always expands the
+/// move that is cheapest to prove or disprove, according to the proof and
+/// disproof numbers kept in a transposition table of fixed size, so forcing
+/// lines are found without searching every reply to the same depth.
+///
+/// Each turn is taken as a dot placed with all its connections made. Only
+/// placements within reach of the target are tried; the other players may
+/// also play one point out of reach, which stands for all of them. Both a
+/// proof and a disproof therefore only cover the placements near the target:
+/// a reply farther out, such as a dot blocking a diagonal of the wall or a
+/// capture of one of its dots, may still refute a proof.
+class ProofSearch
+{
+public:
+    enum Result
+    {
+        ProvenResult,
+        DisprovenResult,
+        UnknownResult
+    };
+
+    explicit ProofSearch(int tableSize = DEFAULT_TABLE_SIZE);
+
+    /// Searches for a forced capture of the dot at the target point, within
+    /// the specified number of turns of the player to move.
+    ///
+    /// The search gives up once stopped() returns true, which is checked
+    /// before each expansion.
+    ///
+    /// \returns UnknownResult if neither was shown within the node budget.
+    Result search(
+        const GameEngine &position,
+        const QPoint &target,
+        int turns,
+        int nodeBudget,
+        const std::function<bool()> &stopped);
+
+    /// Gets the placements of the forcing line of the last proof, one per
+    /// turn, as far as the transposition table has kept it.
+    const std::vector<QPoint> &line() const;
+
+    /// Gets the number of positions created by the last search.
+    int nodeCount() const;
+
+    static const int DEFAULT_TABLE_SIZE = 1 << 16;
+
+private:
+    struct Entry
+    {
+        quint64 key;
+        quint32 proof;
+        quint32 disproof;
+        quint32 work;
+    };
+
+    /// A move from a node, which keeps the key of the position it leads to
+    /// rather than the position itself.
+    struct Child
+    {
+        quint64 key;
+        QPoint move;
+        int turnsLeft;
+        bool terminal;
+        quint32 proof;
+        quint32 disproof;
+    };
+
+    void searchNode(
+        const GameEngine &position,
+        int ply,
+        int turnsLeft,
+        quint32 proofThreshold,
+        quint32 disproofThreshold);
+    std::vector<Child> expand(
+        const GameEngine &position,
+        int turnsLeft,
+        GameEngine &scratch);
+    std::vector<QPoint> findMoves(
+        const GameEngine &position,
+        int turnsLeft) const;
+    bool isTerminal(
+        const GameEngine &position,
+        int turnsLeft,
+        quint32 &proof,
+        quint32 &disproof) const;
+    void readChild(Child &child) const;
+    bool lookUp(
+        quint64 key,
+        quint32 &proof,
+        quint32 &disproof,
+        quint32 &work) const;
+    void store(
+        quint64 key,
+        quint32 proof,
+        quint32 disproof,
+        quint32 work);
+    void readLine(const GameEngine &position, int turns);
+    GameEngine &positionAt(int ply);
+
+    static quint64 tableKey(const GameEngine &position, int turnsLeft);
+    static void makeMove(GameEngine &engine, const QPoint &move);
+
+    static const quint32 INFINITE_NUMBER = 1u << 30;
+
+    std::vector<Entry> m_table;
+
+    // the engine the children of a node at each ply are made on, so that no
+    // node constructs one
+    std::vector<std::unique_ptr<GameEngine>> m_positions;
+    std::vector<QPoint> m_line;
+    int m_attacker;
+    QPoint m_target;
+    int m_nodeCount;
+    int m_nodeBudget;
+    std::function<bool()> m_stopped;
+};
+
+#endif // PROOFSEARCH_H
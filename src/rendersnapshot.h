@@ -0,0 +1,48 @@
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include "dot.h"
+#include <QBitArray>
+#include <QtGlobal>
+#include <vector>
+
+/// Immutable copy of what a board draws of a game.
+///
+/// The engine publishes a new snapshot after each change, so the render
+/// thread can draw one without reading the engine while it is being changed.
+struct RenderSnapshot
+{
+    struct Segment
+    {
+        Dot endpoint1;
+        Dot endpoint2;
+    };
+
+    /// Increases with every snapshot published by an engine.
+    quint64 version;
+
+    int rows;
+    int columns;
+    int currentPlayer;
+
+    /// Whether the current player is to place a dot rather than connect dots.
+    bool placingDot;
+
+    /// The points where a dot can be placed, indexed by y * (columns + 1) + x.
+    QBitArray placeablePoints;
+
+    /// The points each player could capture with their next placement and
+    /// connections, indexed like the placeable points. Empty unless a board
+    /// has retained the threats with GameEngine::retainThreats().
+    std::vector<QBitArray> threatenedPoints;
+
+    /// The dots in the order they were placed.
+    std::vector<Dot> dots;
+
+    /// The lines of each player in the order they were finalized.
+    std::vector<std::vector<Segment>> lines;
+
+    std::vector<std::vector<Dot>> chains;
+};
+
+#endif // RENDERSNAPSHOT_H
@@ -0,0 +1,25 @@
+#include "shaderscale.h"
+#include <QMatrix4x4>
+#include <QRect>
+#include <cmath>
+
+float ShaderScale::pixelSize(const QSGMaterialShader::RenderState &state)
+{
+    // the matrix maps the geometry to normalised device coordinates, which
+    // span the viewport from -1 to 1 on either axis
+    const QMatrix4x4 matrix = state.combinedMatrix();
+    const QRect viewport = state.viewportRect();
+    const qreal scaleX = viewport.width() * 0.5;
+    const qreal scaleY = viewport.height() * 0.5;
+    const qreal area = std::abs(
+        (matrix(0, 0) * matrix(1, 1) - matrix(0, 1) * matrix(1, 0)) * scaleX
+        * scaleY);
+
+    if (qFuzzyIsNull(area)) {
+        return 1;
+    }
+
+    // the board is scaled alike on both axes, so a device pixel covers a
+    // square of the geometry with the same area
+    return static_cast<float>(1 / std::sqrt(area));
+}
@@ -0,0 +1,19 @@
+#ifndef SHADERSCALE_H
+#define SHADERSCALE_H
+
+#include <QSGMaterialShader>
+
+/// Measures the scale at which a material shader draws its geometry, so that
+/// antialiasing stays a device pixel wide however the board is zoomed or
+/// rotated, and whatever the pixel density of the display.
+class ShaderScale
+{
+public:
+    /// Gets the size of a device pixel in the units of the geometry, from
+    /// the combined matrix and the viewport of the render state.
+    ///
+    /// \returns the size, or 1 if the geometry is scaled to nothing.
+    static float pixelSize(const QSGMaterialShader::RenderState &state);
+};
+
+#endif // SHADERSCALE_H
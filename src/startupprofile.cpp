@@ -0,0 +1,110 @@
+#include "startupprofile.h"
+#include <QElapsedTimer>
+#include <QQuickWindow>
+
+namespace
+{
+    QElapsedTimer startedTimer()
+    {
+        QElapsedTimer timer;
+
+        timer.start();
+
+        return timer;
+    }
+
+    // started during static initialization, before main() is entered, which
+    // is the closest the application gets to the start of the process
+    const QElapsedTimer processTimer = startedTimer();
+}
+
+StartupProfile::StartupProfile(QObject *parent)
+    : QObject(parent)
+    , m_enabled(!qgetenv("PAPERCHESS_STARTUP_PROFILE").isEmpty())
+    , m_firstFrameShown(false)
+{
+}
+
+bool StartupProfile::isEnabled() const
+{
+    return m_enabled;
+}
+
+void StartupProfile::mark(const QString &event)
+{
+    if (m_enabled) {
+        record(event, processTimer.nsecsElapsed(), -1);
+    }
+}
+
+void StartupProfile::begin(const QString &name)
+{
+    if (m_enabled) {
+        m_beginTimes.insert(name, processTimer.nsecsElapsed());
+    }
+}
+
+void StartupProfile::end(const QString &name)
+{
+    if (!m_enabled || !m_beginTimes.contains(name)) {
+        return;
+    }
+
+    const qint64 beginTime = m_beginTimes.take(name);
+
+    record(name, beginTime, processTimer.nsecsElapsed() - beginTime);
+}
+
+void StartupProfile::watchFirstFrame(QQuickWindow *window)
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    // frames are swapped on the render thread, so the connection is queued
+    // and more frames may already be queued when the first one arrives
+    m_frameConnection = connect(
+        window,
+        &QQuickWindow::frameSwapped,
+        this,
+        [this]() {
+            if (m_firstFrameShown) {
+                return;
+            }
+
+            disconnect(m_frameConnection);
+            mark(QStringLiteral("first frame"));
+
+            m_firstFrameShown = true;
+
+            for (const Event &event : m_events) {
+                print(event);
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+void StartupProfile::record(const QString &name, qint64 time, qint64 duration)
+{
+    m_events.append({name, time, duration});
+
+    if (m_firstFrameShown) {
+        print(m_events.last());
+    }
+}
+
+void StartupProfile::print(const Event &event) const
+{
+    if (event.duration < 0) {
+        qInfo(
+            "startup: %9.3f ms  %s",
+            event.time / 1e6,
+            qPrintable(event.name));
+    } else {
+        qInfo(
+            "startup: %9.3f ms  %s (%.3f ms)",
+            event.time / 1e6,
+            qPrintable(event.name),
+            event.duration / 1e6);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+class QQuickWindow;
+
+/// Timeline of the application's startup, from the start of the process to
+/// the first frame, followed by the creation of each page.
+///
+/// Profiling is enabled by setting PAPERCHESS_STARTUP_PROFILE to any value;
+/// the timeline is printed when the first frame is shown, and every event
+/// after that as it happens. Otherwise recording an event does nothing.
+class StartupProfile : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled CONSTANT)
+
+public:
+    explicit StartupProfile(QObject *parent = nullptr);
+
+    bool isEnabled() const;
+
+    /// Records an event at the current time.
+    Q_INVOKABLE void mark(const QString &event);
+
+    /// Starts timing the named step, which is recorded when it ends.
+    Q_INVOKABLE void begin(const QString &name);
+    Q_INVOKABLE void end(const QString &name);
+
+    /// Records the first frame swapped by the window and prints the timeline.
+    void watchFirstFrame(QQuickWindow *window);
+
+private:
+    struct Event
+    {
+        QString name;
+        qint64 time;
+        qint64 duration;
+    };
+
+    void record(const QString &name, qint64 time, qint64 duration);
+    void print(const Event &event) const;
+
+    bool m_enabled;
+    bool m_firstFrameShown;
+    QMetaObject::Connection m_frameConnection;
+    QVector<Event> m_events;
+    QHash<QString, qint64> m_beginTimes;
+};
+
+#endif // STARTUPPROFILE_H
@@ -0,0 +1,309 @@
+#include "threatmap.h"
+#include "dot.h"
+#include "gameengine.h"
+#include <algorithm>
+
+ThreatMap::ThreatMap()
+    : m_numPlayers(0)
+    , m_rows(0)
+    , m_columns(0)
+{
+}
+
+void ThreatMap::reset(int numPlayers, int rows, int columns)
+{
+    const int pointCount = (rows + 1) * (columns + 1);
+
+    m_numPlayers = numPlayers;
+    m_rows = rows;
+    m_columns = columns;
+    m_threatenedPoints.assign(numPlayers, QBitArray(pointCount, false));
+    m_orderByPoint.assign(pointCount, -1);
+    m_changedPoints.clear();
+
+    for (int i = 0; i < pointCount; ++i) {
+        m_changedPoints.push_back(i);
+    }
+}
+
+void ThreatMap::markChanged(int x, int y)
+{
+    m_changedPoints.push_back(y * (m_columns + 1) + x);
+}
+
+int ThreatMap::update(const GameEngine &engine)
+{
+    if (m_changedPoints.empty()) {
+        return 0;
+    }
+
+    // a change to a point can split or join the regions it borders, so the
+    // analysis starts from each of its neighbours
+    std::vector<int> seeds;
+
+    for (int index : m_changedPoints) {
+        const int x = index % (m_columns + 1);
+        const int y = index / (m_columns + 1);
+
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (isInside(x + dx, y + dy)) {
+                    seeds.push_back((y + dy) * (m_columns + 1) + x + dx);
+                }
+            }
+        }
+    }
+
+    m_changedPoints.clear();
+
+    int visitedCount = 0;
+
+    for (int player = 0; player < m_numPlayers; ++player) {
+        for (int seed : seeds) {
+            if (isWall(engine, player, seed)) {
+                m_threatenedPoints[player].clearBit(seed);
+            } else if (m_orderByPoint[seed] < 0) {
+                analyseRegion(engine, player, seed);
+            }
+        }
+
+        visitedCount += static_cast<int>(m_points.size());
+
+        for (int index : m_points) {
+            m_orderByPoint[index] = -1;
+        }
+
+        m_points.clear();
+        m_parents.clear();
+        m_lows.clear();
+        m_ends.clear();
+        m_borderCounts.clear();
+        m_cutBorderCounts.clear();
+        m_cutSizes.clear();
+        m_placeable.clear();
+        m_restEnclosed.clear();
+    }
+
+    return visitedCount;
+}
+
+QBitArray ThreatMap::threatenedPoints(int player) const
+{
+    return m_threatenedPoints[player];
+}
+
+bool ThreatMap::isInside(int x, int y) const
+{
+    return x >= 0 && x <= m_columns && y >= 0 && y <= m_rows;
+}
+
+bool ThreatMap::isOnBorder(int index) const
+{
+    const int x = index % (m_columns + 1);
+    const int y = index / (m_columns + 1);
+
+    return x == 0 || x == m_columns || y == 0 || y == m_rows;
+}
+
+bool ThreatMap::isWall(const GameEngine &engine, int player, int index) const
+{
+    const Dot *dot =
+        engine.getDotAt(index % (m_columns + 1), index / (m_columns + 1));
+
+    return dot != nullptr && dot->isActive() && dot->player() == player;
+}
+
+bool ThreatMap::findNeighbor(
+    const GameEngine &engine,
+    int player,
+    int index,
+    int direction,
+    int &neighbor) const
+{
+    // the orthogonal directions come first
+    static const int dxs[] = {1, 0, -1, 0, 1, -1, -1, 1};
+    static const int dys[] = {0, 1, 0, -1, 1, 1, -1, -1};
+
+    const int x = index % (m_columns + 1);
+    const int y = index / (m_columns + 1);
+    const int neighborX = x + dxs[direction];
+    const int neighborY = y + dys[direction];
+
+    if (!isInside(neighborX, neighborY)) {
+        return false;
+    }
+
+    neighbor = neighborY * (m_columns + 1) + neighborX;
+
+    if (isWall(engine, player, neighbor)) {
+        return false;
+    }
+
+    if (direction < 4) {
+        return true;
+    }
+
+    // the player's dots at the other two corners could be connected across a
+    // diagonal step, unless a connection between its ends is in the way
+    const Dot *dot = engine.getDotAt(x, y);
+    const Dot *neighborDot = engine.getDotAt(neighborX, neighborY);
+
+    return dot != nullptr && neighborDot != nullptr
+        && engine.areConnected(*dot, *neighborDot);
+}
+
+void ThreatMap::visit(const GameEngine &engine, int index, int parent)
+{
+    const int order = static_cast<int>(m_points.size());
+
+    m_orderByPoint[index] = order;
+    m_points.push_back(index);
+    m_parents.push_back(parent);
+    m_lows.push_back(order);
+    m_ends.push_back(order + 1);
+    m_borderCounts.push_back(isOnBorder(index) ? 1 : 0);
+    m_cutBorderCounts.push_back(0);
+    m_cutSizes.push_back(0);
+    m_placeable.push_back(engine.canPlaceDot(
+        index % (m_columns + 1), index / (m_columns + 1)));
+    m_restEnclosed.push_back(false);
+}
+
+void ThreatMap::analyseRegion(const GameEngine &engine, int player, int root)
+{
+    // Implementation note: Iterative DFS finding the articulation points of
+    // the region, where a placed dot would split it. The descendants of a
+    // point are visited in a contiguous range of orders, so the parts split
+    // off are marked as ranges and resolved with a running sum.
+
+    struct Frame
+    {
+        int order;
+        int direction;
+    };
+
+    const int base = static_cast<int>(m_points.size());
+    std::vector<Frame> stack;
+
+    m_cutChildren.clear();
+
+    visit(engine, root, -1);
+    stack.push_back({base, 0});
+
+    while (!stack.empty()) {
+        const int order = stack.back().order;
+        int child = -1;
+
+        while (stack.back().direction < 8) {
+            int neighbor;
+
+            if (!findNeighbor(
+                    engine,
+                    player,
+                    m_points[order],
+                    stack.back().direction++,
+                    neighbor)) {
+                continue;
+            }
+
+            if (m_orderByPoint[neighbor] < 0) {
+                child = neighbor;
+
+                break;
+            }
+
+            if (m_orderByPoint[neighbor] != m_parents[order]) {
+                m_lows[order] =
+                    std::min(m_lows[order], m_orderByPoint[neighbor]);
+            }
+        }
+
+        if (child >= 0) {
+            visit(engine, child, order);
+            stack.push_back({static_cast<int>(m_points.size()) - 1, 0});
+
+            continue;
+        }
+
+        stack.pop_back();
+        m_ends[order] = static_cast<int>(m_points.size());
+
+        const int parent = m_parents[order];
+
+        if (parent < 0) {
+            continue;
+        }
+
+        m_borderCounts[parent] += m_borderCounts[order];
+        m_lows[parent] = std::min(m_lows[parent], m_lows[order]);
+
+        // nothing below this point reaches above its parent, so a dot placed
+        // at the parent would cut it off
+        if (m_lows[order] >= parent) {
+            m_cutChildren.push_back(order);
+            m_cutBorderCounts[parent] += m_borderCounts[order];
+            m_cutSizes[parent] += m_ends[order] - order;
+        }
+    }
+
+    const int end = static_cast<int>(m_points.size());
+    const int borderCount = m_borderCounts[base];
+
+    m_marks.assign(end - base + 1, 0);
+
+    auto mark = [&](int first, int last, int amount) {
+        m_marks[first - base] += amount;
+        m_marks[last - base] -= amount;
+    };
+
+    if (borderCount == 0) {
+        // the region is cut off already
+        mark(base, end, 1);
+    } else {
+        for (int order = base; order < end; ++order) {
+            const int restSize = end - base - 1 - m_cutSizes[order];
+            const int restBorderCount = borderCount
+                - (isOnBorder(m_points[order]) ? 1 : 0)
+                - m_cutBorderCounts[order];
+
+            // what is left of the region besides the parts split off may be
+            // the part cut off from the borders
+            m_restEnclosed[order] =
+                m_placeable[order] && restSize > 0 && restBorderCount == 0;
+
+            if (m_restEnclosed[order]) {
+                mark(base, end, 1);
+                mark(order, order + 1, -1);
+            }
+        }
+
+        for (int child : m_cutChildren) {
+            const int parent = m_parents[child];
+
+            if (!m_placeable[parent]) {
+                continue;
+            }
+
+            if (m_restEnclosed[parent]) {
+                mark(child, m_ends[child], -1);
+            }
+
+            if (m_borderCounts[child] == 0) {
+                mark(child, m_ends[child], 1);
+            }
+        }
+    }
+
+    int markCount = 0;
+
+    for (int order = base; order < end; ++order) {
+        const int index = m_points[order];
+        const Dot *dot =
+            engine.getDotAt(index % (m_columns + 1), index / (m_columns + 1));
+        const bool capturable =
+            m_placeable[order] || (dot != nullptr && dot->isActive());
+
+        markCount += m_marks[order - base];
+        m_threatenedPoints[player].setBit(index, markCount > 0 && capturable);
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef THREATMAP_H
+#define THREATMAP_H
+
+#include <QBitArray>
+#include <vector>
+
+class GameEngine;
+
+/// The points each player could capture with their next placement and the
+/// connections it allows.
+///
+/// A player's dots, connected to their neighbours, wall off regions of the
+/// remaining points. A region is threatened if it is already cut off from the
+/// borders, and part of a region is threatened if a dot placed at a single
+/// point would cut it off. Only the regions containing the points changed
+/// since the last update are analysed again, once per player. A move within
+/// a small enclosure costs little, but the open region of a sparse board
+/// spans most of it, so a move there costs a search of most of the board.
+///
+/// Connections are assumed to be possible between any neighbouring dots of a
+/// player, unless they would cross an existing connection.
+class ThreatMap
+{
+public:
+    ThreatMap();
+
+    /// Clears the map for a new board, all of which is analysed by the next
+    /// update.
+    void reset(int numPlayers, int rows, int columns);
+
+    /// Marks the point as changed, by a dot, a connection or a capture.
+    void markChanged(int x, int y);
+
+    /// Analyses the regions around the changed points.
+    ///
+    /// \returns the number of points visited.
+    int update(const GameEngine &engine);
+
+    /// Gets the points threatened by the specified player, indexed by
+    /// y * (columns + 1) + x. Only empty points and the active dots of the
+    /// other players can be threatened.
+    QBitArray threatenedPoints(int player) const;
+
+private:
+    bool isInside(int x, int y) const;
+    bool isOnBorder(int index) const;
+    bool isWall(const GameEngine &engine, int player, int index) const;
+    bool findNeighbor(
+        const GameEngine &engine,
+        int player,
+        int index,
+        int direction,
+        int &neighbor) const;
+    void visit(const GameEngine &engine, int index, int parent);
+    void analyseRegion(const GameEngine &engine, int player, int root);
+
+    int m_numPlayers;
+    int m_rows;
+    int m_columns;
+    std::vector<QBitArray> m_threatenedPoints;
+    std::vector<int> m_changedPoints;
+
+    // scratch space of the depth-first search over a region, indexed by the
+    // order in which the points are visited
+    std::vector<int> m_orderByPoint;
+    std::vector<int> m_points;
+    std::vector<int> m_parents;
+    std::vector<int> m_lows;
+    std::vector<int> m_ends;
+    std::vector<int> m_borderCounts;
+    std::vector<int> m_cutBorderCounts;
+    std::vector<int> m_cutSizes;
+    std::vector<char> m_placeable;
+    std::vector<char> m_restEnclosed;
+    std::vector<int> m_cutChildren;
+    std::vector<int> m_marks;
+};
+
+#endif // THREATMAP_H
@@ -0,0 +1,166 @@
+#include "tracing.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QTextStream>
+#include <QThread>
+#include <atomic>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char *name;
+        qint64 start;
+        qint64 duration;
+    };
+
+    /// The events of a single thread.
+    ///
+    /// Only the owning thread writes; the count is published after each
+    /// event, so the trace can be written while the thread is still running.
+    struct ThreadBuffer
+    {
+        static const int CAPACITY = 1 << 16;
+
+        int id;
+        QString name;
+        std::vector<Event> events;
+        std::atomic<int> count;
+        std::atomic<int> dropped;
+    };
+
+    std::atomic<bool> enabled(false);
+    QString path;
+    QElapsedTimer clock;
+
+    // buffers are only added to the list, and are never deleted, so that the
+    // events of finished threads are still written
+    QMutex buffersMutex;
+    std::vector<ThreadBuffer *> buffers;
+
+    ThreadBuffer *threadBuffer()
+    {
+        thread_local ThreadBuffer *buffer = nullptr;
+
+        if (buffer == nullptr) {
+            QMutexLocker locker(&buffersMutex);
+            QThread *thread = QThread::currentThread();
+
+            buffer = new ThreadBuffer();
+            buffer->id = static_cast<int>(buffers.size()) + 1;
+            buffer->name = thread->objectName();
+            buffer->events.resize(ThreadBuffer::CAPACITY);
+            buffer->count.store(0);
+            buffer->dropped.store(0);
+
+            if (thread == QCoreApplication::instance()->thread()) {
+                buffer->name = QStringLiteral("main");
+            } else if (buffer->name.isEmpty()) {
+                buffer->name = QStringLiteral("thread %1").arg(buffer->id);
+            }
+
+            buffers.push_back(buffer);
+        }
+
+        return buffer;
+    }
+}
+
+Tracing::Span::Span(const char *name)
+    : m_name(name)
+    , m_start(isEnabled() ? clock.nsecsElapsed() : 0)
+{
+}
+
+Tracing::Span::~Span()
+{
+    if (isEnabled()) {
+        record(m_name, m_start, clock.nsecsElapsed());
+    }
+}
+
+void Tracing::initialize()
+{
+    path = QString::fromLocal8Bit(qgetenv("PAPERCHESS_TRACE"));
+
+    if (path.isEmpty()) {
+        return;
+    }
+
+    clock.start();
+    qAddPostRoutine(&Tracing::write);
+    enabled.store(true);
+}
+
+bool Tracing::isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void Tracing::record(const char *name, qint64 start, qint64 end)
+{
+    ThreadBuffer *buffer = threadBuffer();
+    const int count = buffer->count.load(std::memory_order_relaxed);
+
+    if (count == ThreadBuffer::CAPACITY) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+
+        return;
+    }
+
+    buffer->events[count] = {name, start, end - start};
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+void Tracing::write()
+{
+    enabled.store(false);
+
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Tracing: cannot write %s", qPrintable(path));
+
+        return;
+    }
+
+    QTextStream stream(&file);
+    QMutexLocker locker(&buffersMutex);
+    const char *separator = "";
+
+    stream.setRealNumberNotation(QTextStream::FixedNotation);
+    stream.setRealNumberPrecision(3);
+
+    stream << "{\"traceEvents\":[";
+
+    // timestamps and durations are in microseconds
+    for (const ThreadBuffer *buffer : buffers) {
+        const int count = buffer->count.load(std::memory_order_acquire);
+
+        stream << separator << "\n{\"name\":\"thread_name\",\"ph\":\"M\","
+               << "\"pid\":1,\"tid\":" << buffer->id
+               << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+        separator = ",";
+
+        for (int i = 0; i < count; ++i) {
+            const Event &event = buffer->events[i];
+
+            stream << ",\n{\"name\":\"" << event.name
+                   << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                   << ",\"ts\":" << event.start / 1000.0
+                   << ",\"dur\":" << event.duration / 1000.0 << "}";
+        }
+
+        if (buffer->dropped.load() > 0) {
+            qWarning(
+                "Tracing: dropped %d events of %s",
+                buffer->dropped.load(),
+                qPrintable(buffer->name));
+        }
+    }
+
+    stream << "\n]}\n";
+}
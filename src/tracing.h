@@ -0,0 +1,44 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QtGlobal>
+
+/// Records scoped spans and writes them as a Chrome trace event file, which
+/// can be opened in chrome://tracing or Perfetto.
+///
+/// Tracing is enabled by setting PAPERCHESS_TRACE to the path of the file to
+/// write when the application exits. Each thread records into a buffer of its
+/// own without locking, so every thread appears on a separate track.
+class Tracing
+{
+public:
+    /// Records the time from its construction until it goes out of scope.
+    class Span
+    {
+    public:
+        /// \param name a string literal, which is kept by reference.
+        explicit Span(const char *name);
+        ~Span();
+
+    private:
+        const char *m_name;
+        qint64 m_start;
+    };
+
+    /// Reads the environment and, if tracing is enabled, arranges for the
+    /// trace to be written when the application object is destroyed.
+    ///
+    /// Must be called on the main thread after the application object has
+    /// been created; spans are not recorded before.
+    static void initialize();
+
+    static bool isEnabled();
+
+private:
+    static void record(const char *name, qint64 start, qint64 end);
+    static void write();
+};
+
+#define TRACE_SPAN(name) Tracing::Span traceSpan(name)
+
+#endif // TRACING_H